@@ -0,0 +1,188 @@
+//  ***************************************************************************
+/// @file    bench.c
+/// @author  NeoProg
+/// @brief   Host micro-benchmarks: timer and JSON report
+//  ***************************************************************************
+#define _GNU_SOURCE
+#include "bench.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_MAX_RESULTS                   (128)
+#define BENCH_QUICK_DIVIDER                 (100)
+#define BENCH_MAX_NAME_LENGTH               (64)
+#define BENCH_MAX_REPEATS                   (16)
+
+
+typedef struct {
+    char name[BENCH_MAX_NAME_LENGTH];
+    double values[BENCH_MAX_REPEATS];                   // Values of repeated runs (median is reported)
+    uint32_t values_count;
+    const char* unit;
+    bool is_lower_better;
+} bench_result_t;
+
+
+static bench_result_t results[BENCH_MAX_RESULTS];
+static uint32_t results_count = 0;
+static bool is_quick = false;
+
+
+static double result_get_median(const bench_result_t* result);
+static int compare_samples(const void* a, const void* b);
+static int compare_values(const void* a, const void* b);
+
+
+//  ***************************************************************************
+/// @brief  Enable quick mode (reduced iterations count for smoke tests)
+/// @param  is_enable: true - quick mode, false - full run
+/// @return none
+//  ***************************************************************************
+void bench_set_quick_mode(bool is_enable) {
+    is_quick = is_enable;
+}
+
+//  ***************************************************************************
+/// @brief  Get monotonic time / CPU time of current thread
+/// @return time in nanoseconds
+//  ***************************************************************************
+uint64_t bench_get_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+uint64_t bench_get_cpu_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+//  ***************************************************************************
+/// @brief  Get iterations count for benchmark
+/// @param  count: iterations count for full run
+/// @return iterations count (reduced in quick mode)
+//  ***************************************************************************
+uint32_t bench_iterations(uint32_t count) {
+    if (is_quick) {
+        count /= BENCH_QUICK_DIVIDER;
+    }
+    return count ? count : 1;
+}
+
+//  ***************************************************************************
+/// @brief  Add result to report
+/// @note   Result with same name is added as repeated run value, report
+///         contains median of values
+/// @param  name: result name ("<module>.<benchmark>[.<metric>]")
+/// @param  value: result value
+/// @param  unit: value unit
+/// @param  is_lower_better: true - lower value is better, false - higher value is better
+/// @return none
+//  ***************************************************************************
+void bench_report(const char* name, double value, const char* unit, bool is_lower_better) {
+    fprintf(stderr, "%-48s %14.3f %s\n", name, value, unit);
+    bench_result_t* result = NULL;
+    for (uint32_t i = 0; i < results_count && result == NULL; ++i) {
+        if (strncmp(results[i].name, name, BENCH_MAX_NAME_LENGTH - 1) == 0) {
+            result = &results[i];
+        }
+    }
+    if (result == NULL) {
+        if (results_count >= BENCH_MAX_RESULTS) {
+            return;
+        }
+        result = &results[results_count++];
+        snprintf(result->name, BENCH_MAX_NAME_LENGTH, "%s", name);
+        result->values_count = 0;
+        result->unit = unit;
+        result->is_lower_better = is_lower_better;
+    }
+    if (result->values_count < BENCH_MAX_REPEATS) {
+        result->values[result->values_count++] = value;
+    }
+}
+
+//  ***************************************************************************
+/// @brief  Get percentile of samples (samples array is sorted in place)
+/// @param  samples: samples array
+/// @param  count: samples count
+/// @param  percentile: percentile [0...100]
+/// @return percentile value
+//  ***************************************************************************
+uint64_t bench_percentile(uint64_t* samples, uint32_t count, uint32_t percentile) {
+    if (count == 0) {
+        return 0;
+    }
+    qsort(samples, count, sizeof(uint64_t), compare_samples);
+    uint32_t index = (uint32_t)(((uint64_t)count * percentile) / 100);
+    return samples[index < count ? index : count - 1];
+}
+
+//  ***************************************************************************
+/// @brief  Write report to file
+/// @param  file: output file
+/// @return none
+//  ***************************************************************************
+void bench_write_report(FILE* file) {
+    fprintf(file, "{\n  \"benchmarks\": [\n");
+    for (uint32_t i = 0; i < results_count; ++i) {
+        fprintf(file, "    {\"name\": \"%s\", \"value\": %.6g, \"unit\": \"%s\", \"better\": \"%s\"}%s\n",
+                results[i].name, result_get_median(&results[i]), results[i].unit,
+                results[i].is_lower_better ? "lower" : "higher", (i + 1 < results_count) ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+}
+
+//  ***************************************************************************
+/// @brief  Save report to file
+/// @param  path: output file path, NULL - write to stdout
+/// @return true - success, false - file open error
+//  ***************************************************************************
+bool bench_save_report(const char* path) {
+    if (path == NULL) {
+        bench_write_report(stdout);
+        return true;
+    }
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        perror(path);
+        return false;
+    }
+    bench_write_report(file);
+    fclose(file);
+    return true;
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Get median of result values
+/// @param  result: result
+/// @return median value
+//  ***************************************************************************
+static double result_get_median(const bench_result_t* result) {
+    double values[BENCH_MAX_REPEATS];
+    uint32_t count = result->values_count;
+    memcpy(values, result->values, sizeof(double) * count);
+    qsort(values, count, sizeof(double), compare_values);
+    return (count % 2) ? values[count / 2] : (values[count / 2 - 1] + values[count / 2]) / 2.0;
+}
+
+//  ***************************************************************************
+/// @brief  Compare samples/values for qsort
+//  ***************************************************************************
+static int compare_samples(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+static int compare_values(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
@@ -0,0 +1,83 @@
+//  ***************************************************************************
+/// @file    bench.h
+/// @author  NeoProg
+/// @brief   Host micro-benchmarks: timer and JSON report
+/// @note    Report format (compare two reports by tools/bench_compare.py):
+///          {"benchmarks": [{"name": "...", "value": 1.0, "unit": "...", "better": "lower"}, ...]}
+//  ***************************************************************************
+#ifndef _BENCH_H_
+#define _BENCH_H_
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+
+//  ***************************************************************************
+/// @brief  Enable quick mode (reduced iterations count for smoke tests)
+/// @param  is_enable: true - quick mode, false - full run
+/// @return none
+//  ***************************************************************************
+extern void bench_set_quick_mode(bool is_enable);
+
+//  ***************************************************************************
+/// @brief  Get monotonic time
+/// @return time in nanoseconds
+//  ***************************************************************************
+extern uint64_t bench_get_time_ns(void);
+
+//  ***************************************************************************
+/// @brief  Get CPU time of current thread
+/// @return time in nanoseconds
+//  ***************************************************************************
+extern uint64_t bench_get_cpu_time_ns(void);
+
+//  ***************************************************************************
+/// @brief  Get iterations count for benchmark
+/// @param  count: iterations count for full run
+/// @return iterations count (reduced in quick mode)
+//  ***************************************************************************
+extern uint32_t bench_iterations(uint32_t count);
+
+//  ***************************************************************************
+/// @brief  Add result to report
+/// @note   Result with same name is added as repeated run value, report
+///         contains median of values
+/// @param  name: result name ("<module>.<benchmark>[.<metric>]")
+/// @param  value: result value
+/// @param  unit: value unit
+/// @param  is_lower_better: true - lower value is better, false - higher value is better
+/// @return none
+//  ***************************************************************************
+extern void bench_report(const char* name, double value, const char* unit, bool is_lower_better);
+
+//  ***************************************************************************
+/// @brief  Get percentile of samples (samples array is sorted in place)
+/// @param  samples: samples array
+/// @param  count: samples count
+/// @param  percentile: percentile [0...100]
+/// @return percentile value
+//  ***************************************************************************
+extern uint64_t bench_percentile(uint64_t* samples, uint32_t count, uint32_t percentile);
+
+//  ***************************************************************************
+/// @brief  Write report to file
+/// @param  file: output file
+/// @return none
+//  ***************************************************************************
+extern void bench_write_report(FILE* file);
+
+//  ***************************************************************************
+/// @brief  Save report to file
+/// @param  path: output file path, NULL - write to stdout
+/// @return true - success, false - file open error
+//  ***************************************************************************
+extern bool bench_save_report(const char* path);
+
+// Benchmark suites
+extern void bench_ring_buffer_run(void);
+extern void bench_veeprom_run(void);
+extern void bench_cli_run(void);
+extern void bench_cli_pty_run(void);
+
+
+#endif // _BENCH_H_
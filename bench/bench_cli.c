@@ -0,0 +1,109 @@
+//  ***************************************************************************
+/// @file    bench_cli.c
+/// @author  NeoProg
+/// @brief   CLI benchmarks: bytes, send calls and CPU time per keystroke
+//  ***************************************************************************
+#include "bench.h"
+#include "cli_core.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define SCENARIO_ITERATIONS                 (20000)
+
+
+typedef struct {
+    const char* name;                                   // Scenario name
+    const char* prepare;                                // Keystrokes before measure (not counted)
+    const char* keys;                                   // Measured keystrokes
+} scenario_t;
+
+
+static cli_cmd_status_t noop_handler(cli_session_t* session, int32_t argc, char* argv[]);
+static void send_data(void* context, const char* data);
+
+
+static const char* const noop_args[] = { "first", "second", NULL };
+static const cli_cmd_t cmd_list[] = {
+    { .name = "noop",   .args = noop_args, .handler = noop_handler },
+    { .name = "status", .args = NULL,      .handler = noop_handler }
+};
+static const scenario_t scenario_list[] = {
+    { "cli.type_command",  "",                                          "noop first\r"           },
+    { "cli.insert_middle", "noop 0123456789012345678901234567890\x1B[1~", "abcdefghij"           },
+    { "cli.history_nav",   "noop first\rnoop second\rstatus\r",         "\x1B[A\x1B[A\x1B[B\x1B[B" },
+    { "cli.tab_complete",  "",                                          "no\t\x03st\t\x03"       },
+};
+
+
+//  ***************************************************************************
+/// @brief  Run CLI benchmarks
+/// @return none
+//  ***************************************************************************
+void bench_cli_run(void) {
+    static cli_session_t session;
+    char name[64];
+
+    cli_core_register_commands(cmd_list, sizeof(cmd_list) / sizeof(cmd_list[0]));
+    bench_report("cli.trie_memory", cli_core_get_trie_memory_usage(), "bytes", true);
+
+    for (uint32_t s = 0; s < sizeof(scenario_list) / sizeof(scenario_list[0]); ++s) {
+        const scenario_t* scenario = &scenario_list[s];
+        uint32_t keys_count = strlen(scenario->keys);
+        uint32_t iterations = bench_iterations(SCENARIO_ITERATIONS);
+        uint64_t tx_bytes = 0;
+        uint64_t tx_calls = 0;
+        uint64_t cpu_time = 0;
+
+        for (uint32_t i = 0; i < iterations; ++i) {
+            cli_core_init(&session, send_data, NULL);
+            for (const char* p = scenario->prepare; *p != 0; ++p) {
+                cli_core_symbol_received(&session, *p);
+                cli_core_process(&session);
+            }
+            cli_core_reset_stats(&session);
+
+            uint64_t begin = bench_get_cpu_time_ns();
+            for (const char* p = scenario->keys; *p != 0; ++p) {
+                cli_core_symbol_received(&session, *p);
+                cli_core_process(&session);
+            }
+            cpu_time += bench_get_cpu_time_ns() - begin;
+
+            cli_stats_t stats;
+            cli_core_get_stats(&session, &stats);
+            tx_bytes += stats.tx_bytes;
+            tx_calls += stats.tx_calls;
+        }
+
+        uint64_t keystrokes = (uint64_t)iterations * keys_count;
+        snprintf(name, sizeof(name), "%s.bytes_per_key", scenario->name);
+        bench_report(name, (double)tx_bytes / keystrokes, "bytes", true);
+        snprintf(name, sizeof(name), "%s.calls_per_key", scenario->name);
+        bench_report(name, (double)tx_calls / keystrokes, "calls", true);
+        snprintf(name, sizeof(name), "%s.cpu_per_key", scenario->name);
+        bench_report(name, (double)cpu_time / keystrokes, "ns", true);
+    }
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Command without output
+//  ***************************************************************************
+static cli_cmd_status_t noop_handler(cli_session_t* session, int32_t argc, char* argv[]) {
+    (void)session;
+    (void)argc;
+    (void)argv;
+    return CLI_CMD_DONE;
+}
+
+//  ***************************************************************************
+/// @brief  Send data callback: output is dropped (counted by session statistics)
+//  ***************************************************************************
+static void send_data(void* context, const char* data) {
+    (void)context;
+    (void)data;
+}
@@ -0,0 +1,246 @@
+//  ***************************************************************************
+/// @file    bench_cli_pty.c
+/// @author  NeoProg
+/// @brief   CLI benchmarks over pseudo terminal: requests per second in
+///          interactive mode and in machine mode (framed requests)
+//  ***************************************************************************
+#define _GNU_SOURCE
+#include "bench.h"
+#include "cli_core.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#define REQUEST_ITERATIONS                  (20000)
+#define REQUEST_COMMAND                     ("status")
+#define PROMPT_SUFFIX                       (": \x1B[0m")
+
+
+static cli_cmd_status_t status_handler(cli_session_t* session, int32_t argc, char* argv[]);
+static void* device_thread(void* arg);
+static void device_send_data(void* context, const char* data);
+static void device_send_frame(void* context, const uint8_t* data, uint32_t size);
+static bool host_wait_prompt(int fd);
+static bool host_wait_frame(int fd, uint8_t request_id);
+static uint32_t host_make_frame(uint8_t* buffer, uint8_t request_id, const char* cmd);
+
+
+static const cli_cmd_t cmd_list[] = {
+    { .name = "status", .args = NULL, .handler = status_handler }
+};
+
+
+//  ***************************************************************************
+/// @brief  Run CLI benchmarks over pseudo terminal
+/// @return none
+//  ***************************************************************************
+void bench_cli_pty_run(void) {
+    int master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master_fd < 0 || grantpt(master_fd) != 0 || unlockpt(master_fd) != 0) {
+        perror("posix_openpt");
+        return;
+    }
+    int slave_fd = open(ptsname(master_fd), O_RDWR | O_NOCTTY);
+    if (slave_fd < 0) {
+        perror("ptsname");
+        close(master_fd);
+        return;
+    }
+    struct termios tio;
+    tcgetattr(slave_fd, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slave_fd, TCSANOW, &tio);
+
+    cli_core_register_commands(cmd_list, sizeof(cmd_list) / sizeof(cmd_list[0]));
+    pthread_t thread;
+    pthread_create(&thread, NULL, device_thread, &slave_fd);
+
+    // Interactive mode: type command and wait prompt
+    uint32_t iterations = bench_iterations(REQUEST_ITERATIONS);
+    bool is_ok = true;
+    uint64_t begin = bench_get_time_ns();
+    for (uint32_t i = 0; i < iterations && is_ok; ++i) {
+        is_ok = write(master_fd, "status\r", 7) == 7 && host_wait_prompt(master_fd);
+    }
+    if (is_ok) {
+        bench_report("cli.pty.interactive", iterations * 1e9 / (bench_get_time_ns() - begin), "req/s", false);
+    }
+
+    // Machine mode: send request frame and wait response frame
+    uint8_t frame[CLI_FRAME_MAX_SIZE * 2];
+    is_ok = is_ok && write(master_fd, CLI_MACHINE_MODE_PREAMBLE, CLI_MACHINE_MODE_PREAMBLE_LENGTH) == CLI_MACHINE_MODE_PREAMBLE_LENGTH;
+    begin = bench_get_time_ns();
+    for (uint32_t i = 0; i < iterations && is_ok; ++i) {
+        uint32_t length = host_make_frame(frame, (uint8_t)i, REQUEST_COMMAND);
+        is_ok = write(master_fd, frame, length) == length && host_wait_frame(master_fd, (uint8_t)i);
+    }
+    if (is_ok) {
+        bench_report("cli.pty.framed", iterations * 1e9 / (bench_get_time_ns() - begin), "req/s", false);
+    }
+
+    // Exit request returns session to interactive mode
+    uint32_t length = host_make_frame(frame, 0xFF, "");
+    is_ok = is_ok && write(master_fd, frame, length) == length && host_wait_frame(master_fd, 0xFF) && host_wait_prompt(master_fd);
+    if (!is_ok) {
+        fprintf(stderr, "cli.pty: unexpected device response\n");
+    }
+
+    close(master_fd); // Device thread read fails after master close
+    pthread_join(thread, NULL);
+    close(slave_fd);
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Command with short output
+//  ***************************************************************************
+static cli_cmd_status_t status_handler(cli_session_t* session, int32_t argc, char* argv[]) {
+    (void)argc;
+    (void)argv;
+    cli_core_send(session, "OK\r\n");
+    return CLI_CMD_DONE;
+}
+
+//  ***************************************************************************
+/// @brief  Device thread: CLI session on slave side of pseudo terminal
+/// @param  arg: pointer to slave file descriptor
+//  ***************************************************************************
+static void* device_thread(void* arg) {
+    static cli_session_t session;
+    int fd = *(int*)arg;
+
+    cli_core_init(&session, device_send_data, arg);
+    cli_core_set_frame_callback(&session, device_send_frame);
+
+    char buffer[256];
+    ssize_t count;
+    while ((count = read(fd, buffer, sizeof(buffer))) > 0) {
+        for (ssize_t i = 0; i < count; ++i) {
+            cli_core_symbol_received(&session, buffer[i]);
+            while (session.running_cmd != NULL) {
+                cli_core_process(&session);
+            }
+        }
+    }
+    return NULL;
+}
+
+//  ***************************************************************************
+/// @brief  Send data callbacks: write to slave side of pseudo terminal
+//  ***************************************************************************
+static void device_send_data(void* context, const char* data) {
+    device_send_frame(context, (const uint8_t*)data, strlen(data));
+}
+static void device_send_frame(void* context, const uint8_t* data, uint32_t size) {
+    int fd = *(int*)context;
+    while (size > 0) {
+        ssize_t count = write(fd, data, size);
+        if (count <= 0) {
+            return;
+        }
+        data += count;
+        size -= count;
+    }
+}
+
+//  ***************************************************************************
+/// @brief  Read from master side until prompt is received
+/// @param  fd: master file descriptor
+/// @return true - success, false - read error
+//  ***************************************************************************
+static bool host_wait_prompt(int fd) {
+    const uint32_t suffix_length = strlen(PROMPT_SUFFIX);
+    uint32_t matched = 0;
+    char symbol;
+    while (read(fd, &symbol, 1) == 1) {
+        matched = (symbol == PROMPT_SUFFIX[matched]) ? matched + 1 : (symbol == PROMPT_SUFFIX[0]);
+        if (matched == suffix_length) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//  ***************************************************************************
+/// @brief  Read from master side until response frame is received
+/// @param  fd: master file descriptor
+/// @param  request_id: expected request ID
+/// @return true - DONE response is received, false - read error or bad response
+//  ***************************************************************************
+static bool host_wait_frame(int fd, uint8_t request_id) {
+    uint8_t frame[CLI_FRAME_MAX_SIZE * 2];
+    uint32_t length = 0;
+    while (length < sizeof(frame) && read(fd, &frame[length], 1) == 1) {
+        if (frame[length] != 0x00) {
+            ++length;
+            continue;
+        }
+
+        // COBS decode response header: [id][status]
+        uint8_t header[2];
+        uint32_t header_length = 0;
+        uint32_t read_pos = 0;
+        while (read_pos < length && header_length < sizeof(header)) {
+            uint8_t code = frame[read_pos++];
+            for (uint32_t i = 1; i < code && read_pos < length && header_length < sizeof(header); ++i) {
+                header[header_length++] = frame[read_pos++];
+            }
+            if (code != 0xFF && header_length < sizeof(header)) {
+                header[header_length++] = 0x00;
+            }
+        }
+        return header_length == sizeof(header) && header[0] == request_id && header[1] == CLI_FRAME_STATUS_DONE;
+    }
+    return false;
+}
+
+//  ***************************************************************************
+/// @brief  Make COBS encoded request frame
+/// @param  buffer: output buffer
+/// @param  request_id: request ID
+/// @param  cmd: command text
+/// @return frame length including delimiter
+//  ***************************************************************************
+static uint32_t host_make_frame(uint8_t* buffer, uint8_t request_id, const char* cmd) {
+    uint8_t data[CLI_FRAME_MAX_SIZE];
+    uint32_t length = 0;
+    data[length++] = request_id;
+    for (; *cmd != 0; ++cmd) {
+        data[length++] = (uint8_t)*cmd;
+    }
+    uint16_t crc = 0xFFFF; // CRC16-CCITT (poly 0x1021, init 0xFFFF)
+    for (uint32_t i = 0; i < length; ++i) {
+        crc ^= (uint16_t)(data[i] << 8);
+        for (int32_t b = 0; b < 8; ++b) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    data[length++] = (uint8_t)(crc & 0xFF);
+    data[length++] = (uint8_t)(crc >> 8);
+
+    uint32_t code_pos = 0;
+    uint32_t encoded_length = 1;
+    uint8_t code = 1;
+    for (uint32_t i = 0; i < length; ++i) {
+        if (data[i] != 0x00) {
+            buffer[encoded_length++] = data[i];
+            ++code;
+        }
+        else {
+            buffer[code_pos] = code;
+            code_pos = encoded_length++;
+            code = 1;
+        }
+    }
+    buffer[code_pos] = code;
+    buffer[encoded_length++] = 0x00;
+    return encoded_length;
+}
@@ -0,0 +1,37 @@
+//  ***************************************************************************
+/// @file    bench_main.c
+/// @author  NeoProg
+/// @brief   Benchmark suite entry point
+/// @note    Usage: bench_suite [--quick] [--repeat N] [output.json]
+///          Suite is run N times, report contains median of each result
+//  ***************************************************************************
+#include "bench.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+int main(int argc, char* argv[]) {
+    const char* output_path = NULL;
+    uint32_t repeats_count = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            bench_set_quick_mode(true);
+        }
+        else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeats_count = strtoul(argv[++i], NULL, 0);
+        }
+        else {
+            output_path = argv[i];
+        }
+    }
+
+    for (uint32_t i = 0; i < repeats_count; ++i) {
+        bench_ring_buffer_run();
+        bench_veeprom_run();
+        bench_cli_run();
+        bench_cli_pty_run();
+    }
+    return bench_save_report(output_path) ? 0 : 1;
+}
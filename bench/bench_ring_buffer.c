@@ -0,0 +1,258 @@
+//  ***************************************************************************
+/// @file    bench_ring_buffer.c
+/// @author  NeoProg
+/// @brief   Ring buffer benchmarks: push/pop latency, bulk throughput and
+///          consumer wakeup latency (polling vs data available notification)
+//  ***************************************************************************
+#include "bench.h"
+#include "ring_buffer.h"
+#include "ring_buffer_mirror.h"
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#define PUSH_POP_ITERATIONS                 (10000000)
+#define BULK_ITERATIONS                     (2000000)
+#define WAKEUP_ITERATIONS                   (20000)
+#define MIRROR_BUFFER_SIZE                  (65536)
+#define MIRROR_CHUNK_SIZE                   (4096)
+#define MIRROR_TRANSFER_BLOCKS              (64)
+#define MIRROR_TRANSFER_BLOCK_SIZE          (4u << 20)      // 256 MiB per test
+
+
+typedef struct {
+    bool is_notify;                                     // true - consumer waits data available notification
+    uint32_t count;                                     // Items count for test
+    uint64_t push_time;                                 // Timestamp of last push
+    uint64_t* samples;                                  // Push-to-pop latency samples
+    sem_t data_available;                               // Given by data available callback
+    sem_t consumed;                                     // Item is popped by consumer
+} wakeup_test_t;
+
+
+static volatile uint8_t sink = 0;
+
+
+static void bench_wakeup(bool is_notify);
+static void* wakeup_consumer_thread(void* arg);
+static void wakeup_data_available(ring_buffer_id buffer_id, void* context);
+
+#ifdef __linux__
+typedef struct {
+    ring_buffer_mirror_t buffer;
+    uint64_t size;                                      // Bytes count for transfer
+} mirror_transfer_t;
+
+static void bench_mirror(void);
+static void* mirror_consumer_thread(void* arg);
+#endif
+
+
+//  ***************************************************************************
+/// @brief  Run ring buffer benchmarks
+/// @return none
+//  ***************************************************************************
+void bench_ring_buffer_run(void) {
+    uint8_t data = 0;
+
+    // Single push + pop (empty buffer, producer and consumer in step)
+    ring_buffer_init(RING_BUFFER_1);
+    uint32_t iterations = bench_iterations(PUSH_POP_ITERATIONS);
+    uint64_t begin = bench_get_time_ns();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        ring_buffer_push(RING_BUFFER_1, (uint8_t)i);
+        ring_buffer_pop(RING_BUFFER_1, &data);
+        sink = data;
+    }
+    bench_report("ring_buffer.push_pop", (double)(bench_get_time_ns() - begin) / iterations, "ns/op", true);
+
+    // Push into full buffer (oldest item is overwritten)
+    ring_buffer_init(RING_BUFFER_1);
+    for (uint32_t i = 0; i < RING_BUFFER_SIZE; ++i) {
+        ring_buffer_push(RING_BUFFER_1, (uint8_t)i);
+    }
+    begin = bench_get_time_ns();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        ring_buffer_push(RING_BUFFER_1, (uint8_t)i);
+    }
+    bench_report("ring_buffer.push_overflow", (double)(bench_get_time_ns() - begin) / iterations, "ns/op", true);
+
+    // Bulk: fill whole buffer and drain it
+    ring_buffer_init(RING_BUFFER_1);
+    iterations = bench_iterations(BULK_ITERATIONS);
+    begin = bench_get_time_ns();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        for (uint32_t a = 0; a < RING_BUFFER_SIZE; ++a) {
+            ring_buffer_push(RING_BUFFER_1, (uint8_t)a);
+        }
+        while (ring_buffer_pop(RING_BUFFER_1, &data)) {
+            sink = data;
+        }
+    }
+    uint64_t elapsed = bench_get_time_ns() - begin;
+    bench_report("ring_buffer.bulk_throughput", (double)iterations * RING_BUFFER_SIZE * 1000.0 / elapsed, "MB/s", false);
+
+    // Consumer wakeup: producer thread (ISR model) pushes, consumer thread polls or waits notification
+    bench_wakeup(false);
+    bench_wakeup(true);
+
+#ifdef __linux__
+    bench_mirror();
+#endif
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Push-to-pop latency of consumer thread
+/// @param  is_notify: true - consumer waits data available notification,
+///                    false - consumer polls ring_buffer_is_empty()
+/// @return none
+//  ***************************************************************************
+static void bench_wakeup(bool is_notify) {
+    wakeup_test_t test = { .is_notify = is_notify };
+    test.count = bench_iterations(WAKEUP_ITERATIONS);
+    test.samples = malloc(sizeof(uint64_t) * test.count);
+    sem_init(&test.data_available, 0, 0);
+    sem_init(&test.consumed, 0, 0);
+
+    ring_buffer_init(RING_BUFFER_1);
+    ring_buffer_callbacks_t callbacks = {
+        .data_available = wakeup_data_available,
+        .context = &test
+    };
+    ring_buffer_set_callbacks(RING_BUFFER_1, is_notify ? &callbacks : NULL);
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, wakeup_consumer_thread, &test);
+    for (uint32_t i = 0; i < test.count; ++i) {
+        test.push_time = bench_get_time_ns(); // Published by push critical section
+        ring_buffer_push(RING_BUFFER_1, (uint8_t)i);
+        sem_wait(&test.consumed);
+    }
+    pthread_join(thread, NULL);
+    ring_buffer_set_callbacks(RING_BUFFER_1, NULL);
+
+    const char* prefix = is_notify ? "ring_buffer.notify_latency" : "ring_buffer.polling_latency";
+    char name[64];
+    snprintf(name, sizeof(name), "%s.p50", prefix);
+    bench_report(name, bench_percentile(test.samples, test.count, 50), "ns", true);
+    snprintf(name, sizeof(name), "%s.p99", prefix);
+    bench_report(name, bench_percentile(test.samples, test.count, 99), "ns", true);
+
+    sem_destroy(&test.data_available);
+    sem_destroy(&test.consumed);
+    free(test.samples);
+}
+
+//  ***************************************************************************
+/// @brief  Consumer thread for wakeup latency benchmark
+/// @param  arg: test context
+//  ***************************************************************************
+static void* wakeup_consumer_thread(void* arg) {
+    wakeup_test_t* test = (wakeup_test_t*)arg;
+    uint8_t data = 0;
+    for (uint32_t i = 0; i < test->count; ++i) {
+        if (test->is_notify) {
+            sem_wait(&test->data_available);
+        }
+        else {
+            while (ring_buffer_is_empty(RING_BUFFER_1)) {
+                sched_yield(); // Producer may share CPU with consumer
+            }
+        }
+        ring_buffer_pop(RING_BUFFER_1, &data);
+        test->samples[i] = bench_get_time_ns() - test->push_time;
+        sink = data;
+        sem_post(&test->consumed);
+    }
+    return NULL;
+}
+
+//  ***************************************************************************
+/// @brief  Data available callback: wake consumer thread
+/// @param  buffer_id: ring buffer id
+/// @param  context: test context
+//  ***************************************************************************
+static void wakeup_data_available(ring_buffer_id buffer_id, void* context) {
+    (void)buffer_id;
+    sem_post(&((wakeup_test_t*)context)->data_available);
+}
+
+#ifdef __linux__
+//  ***************************************************************************
+/// @brief  Double-mapped ring buffer throughput (compare with ring_buffer.bulk_throughput)
+/// @return none
+//  ***************************************************************************
+static void bench_mirror(void) {
+    static uint8_t chunk[MIRROR_CHUNK_SIZE];
+    static mirror_transfer_t transfer;
+    if (!ring_buffer_mirror_init(&transfer.buffer, MIRROR_BUFFER_SIZE)) {
+        return;
+    }
+    transfer.size = (uint64_t)bench_iterations(MIRROR_TRANSFER_BLOCKS) * MIRROR_TRANSFER_BLOCK_SIZE;
+
+    // Single thread: push chunk and pop it
+    uint64_t begin = bench_get_time_ns();
+    for (uint64_t total = 0; total < transfer.size; total += MIRROR_CHUNK_SIZE) {
+        ring_buffer_mirror_push(&transfer.buffer, chunk, MIRROR_CHUNK_SIZE);
+        ring_buffer_mirror_pop(&transfer.buffer, chunk, MIRROR_CHUNK_SIZE);
+    }
+    uint64_t elapsed = bench_get_time_ns() - begin;
+    bench_report("ring_buffer_mirror.bulk_throughput", transfer.size * 1000.0 / elapsed, "MB/s", false);
+
+    // Producer and consumer threads: zero-copy regions
+    ring_buffer_mirror_clear(&transfer.buffer);
+    pthread_t thread;
+    begin = bench_get_time_ns();
+    pthread_create(&thread, NULL, mirror_consumer_thread, &transfer);
+    for (uint64_t total = 0; total < transfer.size;) {
+        uint32_t free_size = 0;
+        uint8_t* region = ring_buffer_mirror_get_write_region(&transfer.buffer, &free_size);
+        if (free_size > transfer.size - total) {
+            free_size = (uint32_t)(transfer.size - total);
+        }
+        if (free_size > 0) {
+            region[0] = (uint8_t)total;
+            ring_buffer_mirror_commit(&transfer.buffer, free_size);
+            total += free_size;
+        }
+        else {
+            sched_yield(); // Consumer may share CPU with producer
+        }
+    }
+    pthread_join(thread, NULL);
+    elapsed = bench_get_time_ns() - begin;
+    bench_report("ring_buffer_mirror.spsc_throughput", transfer.size * 1000.0 / elapsed, "MB/s", false);
+
+    ring_buffer_mirror_deinit(&transfer.buffer);
+}
+
+//  ***************************************************************************
+/// @brief  Consumer thread for SPSC throughput benchmark
+/// @param  arg: transfer context
+//  ***************************************************************************
+static void* mirror_consumer_thread(void* arg) {
+    mirror_transfer_t* transfer = (mirror_transfer_t*)arg;
+    uint64_t total = 0;
+    while (total < transfer->size) {
+        uint32_t data_size = 0;
+        const uint8_t* region = ring_buffer_mirror_get_read_region(&transfer->buffer, &data_size);
+        if (data_size > 0) {
+            sink = region[data_size - 1];
+            ring_buffer_mirror_consume(&transfer->buffer, data_size);
+            total += data_size;
+        }
+        else {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+#endif
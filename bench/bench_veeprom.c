@@ -0,0 +1,115 @@
+//  ***************************************************************************
+/// @file    bench_veeprom.c
+/// @author  NeoProg
+/// @brief   VEEPROM benchmarks on simulated FLASH: init, read and write latency
+//  ***************************************************************************
+#include "bench.h"
+#include "veeprom_fixture.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define READ_ITERATIONS                     (2000000)
+#define WRITE_ITERATIONS                    (20000)
+#define INIT_ITERATIONS                     (20000)
+#define MAX_VEEPROM_SIZE                    (4096)
+
+
+static volatile uint8_t sink = 0;
+static uint8_t cache[MAX_VEEPROM_SIZE];
+
+
+static void bench_geometry(const char* prefix, uint32_t page_size, uint32_t program_width);
+
+
+//  ***************************************************************************
+/// @brief  Run VEEPROM benchmarks
+/// @return none
+//  ***************************************************************************
+void bench_veeprom_run(void) {
+    bench_geometry("veeprom.w2", 1024, 2);  // STM32F0/F1: 1 KiB pages, half-word programming
+    bench_geometry("veeprom.w8", 2048, 8);  // STM32G0/L4: 2 KiB pages, double-word programming
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Run benchmarks for FLASH geometry
+/// @param  prefix: results name prefix
+/// @param  page_size: FLASH page size
+/// @param  program_width: FLASH program unit size
+/// @return none
+//  ***************************************************************************
+static void bench_geometry(const char* prefix, uint32_t page_size, uint32_t program_width) {
+    char name[64];
+    veeprom_config_t config;
+    veeprom_t veeprom;
+    veeprom_fixture_init(&veeprom, &config, page_size, 1, program_width, NULL);
+    uint32_t size = veeprom_get_size(&veeprom);
+
+    // Write-through: one page swap per write. Page is filled by random data for fair program count
+    uint8_t* image = malloc(size);
+    srand(1);
+    for (uint32_t i = 0; i < size; ++i) {
+        image[i] = (uint8_t)rand();
+    }
+    veeprom_write(&veeprom, 0, image, size);
+    free(image);
+
+    veeprom_flash_sim_reset_stat();
+    uint32_t iterations = bench_iterations(WRITE_ITERATIONS);
+    uint64_t begin = bench_get_time_ns();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        veeprom_write_32(&veeprom, (i * 4) % (size - 4), i);
+    }
+    uint64_t elapsed = bench_get_time_ns() - begin;
+    veeprom_flash_sim_stat_t stat;
+    veeprom_flash_sim_get_stat(&stat);
+    snprintf(name, sizeof(name), "%s.write", prefix);
+    bench_report(name, (double)elapsed / iterations / 1000.0, "us/op", true);
+    snprintf(name, sizeof(name), "%s.write.programs_per_swap", prefix);
+    bench_report(name, (double)stat.program_count / iterations, "ops", true);
+
+    // Read from FLASH
+    iterations = bench_iterations(READ_ITERATIONS);
+    begin = bench_get_time_ns();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        sink = veeprom_read_8(&veeprom, i % size);
+    }
+    snprintf(name, sizeof(name), "%s.read_8", prefix);
+    bench_report(name, (double)(bench_get_time_ns() - begin) / iterations, "ns/op", true);
+
+    // Init (search active page and check checksum)
+    iterations = bench_iterations(INIT_ITERATIONS);
+    begin = bench_get_time_ns();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        veeprom_init(&veeprom, &config);
+    }
+    snprintf(name, sizeof(name), "%s.init", prefix);
+    bench_report(name, (double)(bench_get_time_ns() - begin) / iterations / 1000.0, "us/op", true);
+
+    // Write-back: writes are coalesced in RAM image, one page swap per flush
+    config.cache = cache;
+    veeprom_init(&veeprom, &config);
+    iterations = bench_iterations(READ_ITERATIONS);
+    begin = bench_get_time_ns();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        veeprom_write_32(&veeprom, (i * 4) % (size - 4), i);
+    }
+    snprintf(name, sizeof(name), "%s.write_back.write", prefix);
+    bench_report(name, (double)(bench_get_time_ns() - begin) / iterations, "ns/op", true);
+
+    iterations = bench_iterations(WRITE_ITERATIONS);
+    begin = bench_get_time_ns();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        veeprom_write_32(&veeprom, 0, i);
+        veeprom_flush(&veeprom);
+    }
+    snprintf(name, sizeof(name), "%s.write_back.flush", prefix);
+    bench_report(name, (double)(bench_get_time_ns() - begin) / iterations / 1000.0, "us/op", true);
+
+    veeprom_flash_sim_deinit();
+}
@@ -3,211 +3,555 @@
 /// @author  NeoProg
 //  ***************************************************************************
 #include "cli_core.h"
+#include "trace.h"
 #include <stdlib.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
 
-#define CLI_MAX_COMMAND_HISTORY_LENGTH			(5)
-#define CLI_MAX_COMMAND_LENGTH					(64) 
 #define CLI_GREETING_STRING						("\x1B[36mroot@hexapod-AIWM: \x1B[0m")
-#define CLI_ESCAPE_SEQUENCES_COUNT				(11)
 
 
-typedef void(*escape_handler_t)(void);
+typedef void(*escape_handler_t)(cli_session_t* session);
 typedef struct {
     char* sequence;
     escape_handler_t handler;
-    bool is_exclude;
 } escape_t;
 
-typedef struct {
-    char cmd[CLI_MAX_COMMAND_LENGTH];
-    int32_t length;
-} cmd_info_t;
-
 typedef enum {
     CLI_STATE_DEFAULT,
     CLI_STATE_ESCAPE
 } cli_state_t;
 
+// Completion trie node. Children are stored as single-linked list (first child -> next sibling)
+typedef struct {
+    char symbol;                                        // Node symbol
+    bool is_terminal;                                   // Node completes command name or argument
+    uint16_t child;                                     // First child node index, 0 - no children
+    uint16_t sibling;                                   // Next sibling node index, 0 - no sibling
+    uint16_t cmd_index;                                 // Command index in registry (for terminal nodes)
+} trie_node_t;
+
+
+static void symbol_process(cli_session_t* session, char symbol);
+static void interactive_symbol_process(cli_session_t* session, char symbol);
+static void escape_state_process(cli_session_t* session, char symbol);
+static void default_state_process(cli_session_t* session, char symbol);
+static void escape_return_handler(cli_session_t* session);
+static void escape_backspace_handler(cli_session_t* session);
+static void escape_del_handler(cli_session_t* session);
+static void escape_up_handler(cli_session_t* session);
+static void escape_down_handler(cli_session_t* session);
+static void escape_left_handler(cli_session_t* session);
+static void escape_right_handler(cli_session_t* session);
+static void escape_home_handler(cli_session_t* session);
+static void escape_end_handler(cli_session_t* session);
+static void escape_search_handler(cli_session_t* session);
+static void escape_tab_handler(cli_session_t* session);
+static void escape_cancel_handler(cli_session_t* session);
+
+static void    search_state_process(cli_session_t* session, char symbol);
+static void    search_update(cli_session_t* session, int32_t start_pos);
+static void    search_finish(cli_session_t* session);
+
+static void    history_put(cli_session_t* session, const cli_cmd_info_t* cmd);
+static int32_t history_prev(cli_session_t* session, int32_t pos);
+static int32_t history_next(cli_session_t* session, int32_t pos);
+static int32_t history_find(cli_session_t* session, int32_t pos, const cli_cmd_info_t* pattern, bool is_prefix, bool is_backward);
+static void    history_get(cli_session_t* session, int32_t pos, cli_cmd_info_t* cmd);
 
-static void escape_state_process(char symbol);
-static void default_state_process(char symbol);
-static void escape_return_handler(void);
-static void escape_backspace_handler(void);
-static void escape_del_handler(void);
-static void escape_up_handler(void);
-static void escape_down_handler(void);
-static void escape_left_handler(void);
-static void escape_right_handler(void);
-static void escape_home_handler(void);
-static void escape_end_handler(void);
-
-
-static const char escape_signature[] = {'\x1B', '\x7F', '\x08', '\x0D', '\x0A' };
-static escape_t escape_list[CLI_ESCAPE_SEQUENCES_COUNT] = {
-    { .sequence = "\x0D",    .handler = escape_return_handler,    .is_exclude = false },
-    { .sequence = "\x0A",    .handler = escape_return_handler,    .is_exclude = false },
-    { .sequence = "\x7F",    .handler = escape_backspace_handler, .is_exclude = false },
-    { .sequence = "\x08",    .handler = escape_backspace_handler, .is_exclude = false },
-    { .sequence = "\x1B[3~", .handler = escape_del_handler,       .is_exclude = false },
-    { .sequence = "\x1B[A",  .handler = escape_up_handler,        .is_exclude = false },
-    { .sequence = "\x1B[B",  .handler = escape_down_handler,      .is_exclude = false },
-    { .sequence = "\x1B[D",  .handler = escape_left_handler,      .is_exclude = false },
-    { .sequence = "\x1B[C",  .handler = escape_right_handler,     .is_exclude = false },
-    { .sequence = "\x1B[4~", .handler = escape_end_handler,       .is_exclude = false },
-    { .sequence = "\x1B[1~", .handler = escape_home_handler,      .is_exclude = false }
+static void     execute_command(cli_session_t* session, const cli_cmd_info_t* cmd);
+static void     finish_command(cli_session_t* session);
+static void     frame_symbol_process(cli_session_t* session, uint8_t symbol);
+static void     frame_request_process(cli_session_t* session);
+static void     frame_start_request(cli_session_t* session, uint8_t request_id, const cli_cmd_info_t* cmd);
+static void     frame_send(cli_session_t* session, uint8_t* frame, int32_t length);
+static uint16_t frame_calc_crc(const uint8_t* data, int32_t length);
+static uint16_t trie_insert(uint16_t node, const char* text);
+static uint16_t trie_find_child(uint16_t node, char symbol);
+static void     trie_print_candidates(cli_session_t* session, uint16_t node, char* word, int32_t word_length);
+
+static void replace_command(cli_session_t* session, const cli_cmd_info_t* cmd);
+static void send_cursor_left(cli_session_t* session, int32_t count);
+static void send_data(cli_session_t* session, const char* data);
+
+
+static const char escape_signature[] = {'\x1B', '\x7F', '\x08', '\x0D', '\x0A', '\x12', '\x09', '\x03' };
+static const escape_t escape_list[CLI_ESCAPE_SEQUENCES_COUNT] = {
+    { .sequence = "\x0D",    .handler = escape_return_handler    },
+    { .sequence = "\x0A",    .handler = escape_return_handler    },
+    { .sequence = "\x7F",    .handler = escape_backspace_handler },
+    { .sequence = "\x08",    .handler = escape_backspace_handler },
+    { .sequence = "\x1B[3~", .handler = escape_del_handler       },
+    { .sequence = "\x1B[A",  .handler = escape_up_handler        },
+    { .sequence = "\x1B[B",  .handler = escape_down_handler      },
+    { .sequence = "\x1B[D",  .handler = escape_left_handler      },
+    { .sequence = "\x1B[C",  .handler = escape_right_handler     },
+    { .sequence = "\x1B[4~", .handler = escape_end_handler       },
+    { .sequence = "\x1B[1~", .handler = escape_home_handler      },
+    { .sequence = "\x12",    .handler = escape_search_handler    },
+    { .sequence = "\x09",    .handler = escape_tab_handler       },
+    { .sequence = "\x03",    .handler = escape_cancel_handler    }
 };
 
-void(*_send_data)(const char* data) = NULL;
+static const cli_cmd_t* registered_cmd_list = NULL;     // Command registry (shared between sessions, read only)
+static int32_t registered_cmd_count = 0;                // Command registry size
+static trie_node_t trie_nodes[CLI_TRIE_MAX_NODES] = {0}; // Completion trie built from command registry, [0] - root
+static uint16_t trie_nodes_count = 1;                   // Used trie nodes count (including root)
+
+
+//  ***************************************************************************
+/// @brief  Register commands and build completion trie
+/// @note   Call before sessions initialization. Registry is shared between sessions
+/// @param  cmd_list: command list (should be available all time)
+/// @param  cmd_count: command list size
+/// @return true - success, false - trie nodes pool is overflow
+//  ***************************************************************************
+bool cli_core_register_commands(const cli_cmd_t* cmd_list, int32_t cmd_count) {
+    registered_cmd_list = cmd_list;
+    registered_cmd_count = cmd_count;
+
+    memset(trie_nodes, 0, sizeof(trie_nodes));
+    trie_nodes_count = 1;
 
-static cli_state_t cli_state = CLI_STATE_DEFAULT; // Current CLI driver state
-static int32_t cursor_pos = 0;                    // Current cursor position (equal cursor position in terminal)
-static cmd_info_t current_cmd = {0};              // Current command information: command text and length
+    // Trie contains command names and "<name> <arg>" strings
+    for (int32_t i = 0; i < cmd_count; ++i) {
+        uint16_t cmd_node = trie_insert(0, cmd_list[i].name);
+        if (cmd_node == 0) {
+            return false;
+        }
+        trie_nodes[cmd_node].is_terminal = true;
+        trie_nodes[cmd_node].cmd_index = i;
 
-static char incoming_escape[10] = {0};            // Buffer for escape sequences
-static int32_t incoming_escape_length = 0;        // Current escape sequence length
-static int32_t possible_escape_sequences_count = CLI_ESCAPE_SEQUENCES_COUNT;
+        for (int32_t a = 0; cmd_list[i].args != NULL && cmd_list[i].args[a] != NULL; ++a) {
+            uint16_t arg_node = trie_insert(cmd_node, " ");
+            if (arg_node != 0) {
+                arg_node = trie_insert(arg_node, cmd_list[i].args[a]);
+            }
+            if (arg_node == 0) {
+                return false;
+            }
+            trie_nodes[arg_node].is_terminal = true;
+            trie_nodes[arg_node].cmd_index = i;
+        }
+    }
+    return true;
+}
 
-static cmd_info_t cmd_history[CLI_MAX_COMMAND_HISTORY_LENGTH] = {0}; // Command history buffer
-static int32_t cmd_history_length = 0;                               // Command history buffer length (command count)
-static int32_t cmd_history_pos = 0;                                  // Current position in history buffer (using for navigation)
+//  ***************************************************************************
+/// @brief  Get completion trie memory usage
+/// @return used trie memory in bytes (max usage is CLI_TRIE_MAX_NODES nodes)
+//  ***************************************************************************
+uint32_t cli_core_get_trie_memory_usage(void) {
+    return trie_nodes_count * sizeof(trie_node_t);
+}
 
 
 //  ***************************************************************************
 /// @brief  CLI core initialization
-/// @param  none
+/// @param  session: CLI session context
+/// @param  send_data: send data callback
+/// @param  context: user context for send data callback
 /// @return none
 //  ***************************************************************************
-void cli_core_init(void(*send_data)(const char*)) {
-    _send_data = send_data;
-    cli_core_reset();
+void cli_core_init(cli_session_t* session, void(*send_data)(void* context, const char* data), void* context) {
+    session->send_data = send_data;
+    session->context = context;
+    session->is_tx_ready = NULL;
+    session->send_frame = NULL;
+    cli_core_reset(session);
 }
 
 //  ***************************************************************************
 /// @brief  Reset CLI core
-/// @param  none
+/// @param  session: CLI session context
+/// @return none
+//  ***************************************************************************
+void cli_core_reset(cli_session_t* session) {
+    session->state = CLI_STATE_DEFAULT;
+    session->cursor_pos = 0;
+    memset(&session->current_cmd, 0, sizeof(session->current_cmd));
+
+    memset(session->incoming_escape, 0, sizeof(session->incoming_escape));
+    session->incoming_escape_length = 0;
+    session->possible_escape_sequences_count = CLI_ESCAPE_SEQUENCES_COUNT;
+    memset(session->escape_exclude, 0, sizeof(session->escape_exclude));
+
+    memset(session->history, 0, sizeof(session->history));
+    session->history_begin = 0;
+    session->history_end = 0;
+    session->history_used = 0;
+    session->history_pos = -1;
+    memset(&session->history_prefix, 0, sizeof(session->history_prefix));
+
+    session->is_search = false;
+    session->is_search_failed = false;
+    session->search_pos = -1;
+    memset(&session->search_pattern, 0, sizeof(session->search_pattern));
+
+    session->is_completion_ambiguous = false;
+
+    session->running_cmd = NULL;
+    session->is_cmd_cancelled = false;
+    session->cmd_step = 0;
+    memset(session->cmd_data, 0, sizeof(session->cmd_data));
+    memset(session->cmd_args, 0, sizeof(session->cmd_args));
+    memset(session->cmd_argv, 0, sizeof(session->cmd_argv));
+    session->cmd_argc = 0;
+
+    session->input_queue_head = 0;
+    session->input_queue_length = 0;
+
+    session->preamble_length = 0;
+    session->is_machine_mode = false;
+    session->is_frame_request = false;
+    session->is_frame_rx_overflow = false;
+    session->frame_rx_length = 0;
+    session->frame_tx_length = 0;
+    session->request_queue_head = 0;
+    session->request_queue_length = 0;
+
+    cli_core_reset_stats(session);
+}
+
+//  ***************************************************************************
+/// @brief  Set TX ready callback
+/// @note   Running command handler is called only if TX is ready (back-pressure)
+/// @param  session: CLI session context
+/// @param  is_tx_ready: TX ready callback, NULL - TX always ready
+/// @return none
+//  ***************************************************************************
+void cli_core_set_tx_ready_callback(cli_session_t* session, bool(*is_tx_ready)(void* context)) {
+    session->is_tx_ready = is_tx_ready;
+}
+
+//  ***************************************************************************
+/// @brief  Set send binary data callback for machine mode
+/// @param  session: CLI session context
+/// @param  send_frame: send binary data callback
 /// @return none
 //  ***************************************************************************
-void cli_core_reset(void) {
-    cli_state = CLI_STATE_DEFAULT;
-    cursor_pos = 0;
-    memset(&current_cmd, 0, sizeof(current_cmd));
-    
-    memset(incoming_escape, 0, sizeof(incoming_escape));
-    incoming_escape_length = 0;
-    possible_escape_sequences_count = CLI_ESCAPE_SEQUENCES_COUNT;
-    for (int32_t i = 0; i < CLI_ESCAPE_SEQUENCES_COUNT; ++i) {
-        escape_list[i].is_exclude = false;
+void cli_core_set_frame_callback(cli_session_t* session, void(*send_frame)(void* context, const uint8_t* data, uint32_t size)) {
+    session->send_frame = send_frame;
+}
+
+//  ***************************************************************************
+/// @brief  Enable/disable machine mode
+/// @note   Machine mode also is enabled by CLI_MACHINE_MODE_PREAMBLE in interactive mode and
+///         disabled by request with empty command text.
+///         Commands receive requests from frames and output is sent in response frames
+/// @param  session: CLI session context
+/// @param  is_enable: true - machine mode, false - interactive mode
+/// @return true - success, false - send binary data callback is not set
+//  ***************************************************************************
+bool cli_core_set_machine_mode(cli_session_t* session, bool is_enable) {
+    if (is_enable && session->send_frame == NULL) {
+        return false;
     }
-    
-    memset(cmd_history, 0, sizeof(cmd_history));
-    cmd_history_length = 0;
-    cmd_history_pos = 0;
+    session->is_machine_mode = is_enable;
+    session->preamble_length = 0;
+    session->is_frame_rx_overflow = false;
+    session->frame_rx_length = 0;
+    session->request_queue_length = 0;
+
+    // Drop line editor state
+    memset(&session->current_cmd, 0, sizeof(session->current_cmd));
+    session->cursor_pos = 0;
+    session->state = CLI_STATE_DEFAULT;
+    session->incoming_escape_length = 0;
+    session->possible_escape_sequences_count = CLI_ESCAPE_SEQUENCES_COUNT;
+    memset(session->escape_exclude, 0, sizeof(session->escape_exclude));
+    session->is_search = false;
+    session->search_pos = -1;
+    session->history_pos = -1;
+    session->input_queue_length = 0;
+    return true;
 }
 
 //  ***************************************************************************
 /// @brief  Process received symbol
+/// @param  session: CLI session context
+/// @param  symbol: received symbol
+/// @return none
+//  ***************************************************************************
+void cli_core_symbol_received(cli_session_t* session, char symbol) {
+    ++session->stats.rx_symbols;
+    symbol_process(session, symbol);
+}
+
+//  ***************************************************************************
+/// @brief  Process running command
+/// @note   Call this function from main loop
+/// @param  session: CLI session context
+/// @return none
+//  ***************************************************************************
+void cli_core_process(cli_session_t* session) {
+
+    if (session->running_cmd == NULL) {
+        return;
+    }
+
+    if (session->is_cmd_cancelled) {
+        if (session->is_frame_request) {
+            session->frame_tx[1] = CLI_FRAME_STATUS_CANCELLED;
+            frame_send(session, session->frame_tx, session->frame_tx_length);
+            session->is_frame_request = false;
+        }
+        else {
+            send_data(session, "^C\r\n");
+        }
+        finish_command(session);
+        return;
+    }
+
+    if (session->is_tx_ready != NULL && !session->is_tx_ready(session->context)) {
+        return; // Wait TX buffer
+    }
+
+    if (session->running_cmd->handler(session, session->cmd_argc, session->cmd_argv) == CLI_CMD_DONE) {
+        finish_command(session);
+    }
+}
+
+//  ***************************************************************************
+/// @brief  Send data to session terminal (for command handlers)
+/// @param  session: CLI session context
+/// @param  data: null-terminated string for send
+/// @return none
+//  ***************************************************************************
+void cli_core_send(cli_session_t* session, const char* data) {
+
+    if (!session->is_frame_request) {
+        send_data(session, data);
+        return;
+    }
+
+    // Put data to response frame. Send partial frame if it is full (space for CRC is reserved)
+    while (*data != 0) {
+        if (session->frame_tx_length >= CLI_FRAME_MAX_SIZE - 2) {
+            session->frame_tx[1] = CLI_FRAME_STATUS_MORE;
+            frame_send(session, session->frame_tx, session->frame_tx_length);
+            session->frame_tx_length = 2;
+        }
+        session->frame_tx[session->frame_tx_length++] = (uint8_t)*data;
+        ++data;
+    }
+}
+
+//  ***************************************************************************
+/// @brief  Format number to HEX string (for command handlers)
+/// @param  str: buffer for string (digits + 1 bytes)
+/// @param  value: number
+/// @param  digits: digits count
+/// @return pointer to null-terminator of string
+//  ***************************************************************************
+char* cli_core_format_hex(char* str, uint32_t value, int32_t digits) {
+    static const char hex_digits[] = "0123456789ABCDEF";
+    for (int32_t i = digits - 1; i >= 0; --i) {
+        str[i] = hex_digits[value & 0x0F];
+        value >>= 4;
+    }
+    str[digits] = 0;
+    return &str[digits];
+}
+
+//  ***************************************************************************
+/// @brief  Format number to decimal string (for command handlers)
+/// @param  str: buffer for string (11 bytes)
+/// @param  value: number
+/// @return pointer to null-terminator of string
+//  ***************************************************************************
+char* cli_core_format_dec(char* str, uint32_t value) {
+    char digits[10] = {0};
+    int32_t digits_count = 0;
+    do {
+        digits[digits_count++] = '0' + value % 10;
+        value /= 10;
+    } while (value);
+    while (digits_count) {
+        *str++ = digits[--digits_count];
+    }
+    *str = 0;
+    return str;
+}
+
+//  ***************************************************************************
+/// @brief  Get session statistics
+/// @param  session: CLI session context
+/// @param  stats: buffer for statistics
+/// @return none
+//  ***************************************************************************
+void cli_core_get_stats(const cli_session_t* session, cli_stats_t* stats) {
+    *stats = session->stats;
+}
+
+//  ***************************************************************************
+/// @brief  Reset session statistics
+/// @param  session: CLI session context
+/// @return none
+//  ***************************************************************************
+void cli_core_reset_stats(cli_session_t* session) {
+    memset(&session->stats, 0, sizeof(session->stats));
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Process received symbol (symbols received from terminal and queued
+///         symbols, received symbols statistics is not changed)
+/// @param  session: CLI session context
+/// @param  symbol: received symbol
+/// @return none
+//  ***************************************************************************
+static void symbol_process(cli_session_t* session, char symbol) {
+
+    if (session->is_machine_mode) {
+        frame_symbol_process(session, (uint8_t)symbol);
+        return;
+    }
+
+    if (session->running_cmd != NULL) {
+        if (symbol == '\x03') {
+            session->is_cmd_cancelled = true; // Cancel command on next cli_core_process() call
+        }
+        else if (session->input_queue_length < CLI_INPUT_QUEUE_SIZE) { // Queue symbol until command complete
+            session->input_queue[(session->input_queue_head + session->input_queue_length) % CLI_INPUT_QUEUE_SIZE] = symbol;
+            ++session->input_queue_length;
+        }
+        return;
+    }
+
+    // Check machine mode preamble. Symbols are hold until preamble is matched or broken
+    if (symbol == CLI_MACHINE_MODE_PREAMBLE[session->preamble_length]) {
+        if (++session->preamble_length == CLI_MACHINE_MODE_PREAMBLE_LENGTH) {
+            session->preamble_length = 0;
+            cli_core_set_machine_mode(session, true);
+        }
+        return;
+    }
+    if (session->preamble_length > 0) {
+        int32_t hold_length = session->preamble_length;
+        session->preamble_length = 0;
+        for (int32_t i = 0; i < hold_length; ++i) {
+            interactive_symbol_process(session, CLI_MACHINE_MODE_PREAMBLE[i]);
+        }
+        symbol_process(session, symbol); // Symbol can start new preamble
+        return;
+    }
+
+    interactive_symbol_process(session, symbol);
+}
+
+//  ***************************************************************************
+/// @brief  Process received symbol in interactive mode (line editor)
+/// @param  session: CLI session context
 /// @param  symbol: received symbol
 /// @return none
 //  ***************************************************************************
-void cli_core_symbol_received(char symbol) {
+static void interactive_symbol_process(cli_session_t* session, char symbol) {
+
+    if (symbol != '\x09') {
+        session->is_completion_ambiguous = false;
+    }
 
     // Check escape signature
-    if (cli_state == CLI_STATE_DEFAULT) { 
+    if (session->state == CLI_STATE_DEFAULT) {
         for (int32_t i = 0; i < sizeof(escape_signature); ++i) {
             if (symbol == escape_signature[i]) {
-                 cli_state = CLI_STATE_ESCAPE;
+                 session->state = CLI_STATE_ESCAPE;
                  break;
             }
         }
     }
 
-    switch (cli_state) {
+    switch (session->state) {
         case CLI_STATE_DEFAULT:
-            default_state_process(symbol);
+            if (session->is_search) {
+                search_state_process(session, symbol);
+                break;
+            }
+            default_state_process(session, symbol);
             break;
         case CLI_STATE_ESCAPE:
-            escape_state_process(symbol);
-            break; 
+            escape_state_process(session, symbol);
+            break;
     }
 }
 
-
-
-
-
 //  ***************************************************************************
 /// @brief  Process state for receive escape sequence
+/// @param  session: CLI session context
 /// @param  symbol: received symbol
 /// @return none
 //  ***************************************************************************
-static void escape_state_process(char symbol) {
+static void escape_state_process(cli_session_t* session, char symbol) {
+
+    if (session->incoming_escape_length < sizeof(session->incoming_escape)) {
+        session->incoming_escape[session->incoming_escape_length++] = symbol;
 
-    if (incoming_escape_length < sizeof(incoming_escape)) {
-        incoming_escape[incoming_escape_length++] = symbol;
-    
         for (int32_t i = 0; i < CLI_ESCAPE_SEQUENCES_COUNT; ++i) {
-            if (escape_list[i].is_exclude == true) {
+            if (session->escape_exclude[i] == true) {
                 continue; // We exclude this escape sequence on previous iterations
             }
-    
+
             int32_t escape_length = strlen(escape_list[i].sequence);
-            for (int32_t a = 0; a < incoming_escape_length && a < escape_length; ++a) {
-                if (incoming_escape[a] != escape_list[i].sequence[a]) {
-                    escape_list[i].is_exclude = true; // Exclude this escape sequence
-                    --possible_escape_sequences_count;
+            for (int32_t a = 0; a < session->incoming_escape_length && a < escape_length; ++a) {
+                if (session->incoming_escape[a] != escape_list[i].sequence[a]) {
+                    session->escape_exclude[i] = true; // Exclude this escape sequence
+                    --session->possible_escape_sequences_count;
                     break;
                 }
             }
         }
-    
-        if (possible_escape_sequences_count == 1) {
+
+        if (session->possible_escape_sequences_count == 1) {
             for (int32_t i = 0; i < CLI_ESCAPE_SEQUENCES_COUNT; ++i) {
-                if (escape_list[i].is_exclude == false) {
-                    if (strlen(escape_list[i].sequence) != incoming_escape_length) {
+                if (session->escape_exclude[i] == false) {
+                    if (strlen(escape_list[i].sequence) != session->incoming_escape_length) {
                         return; // We receive not all symbols - wait next symbol
                     }
-                    escape_list[i].handler();
+                    if (session->is_search && escape_list[i].handler != escape_search_handler && escape_list[i].handler != escape_backspace_handler && escape_list[i].handler != escape_cancel_handler) {
+                        search_finish(session); // Any other key accepts found command
+                    }
+                    escape_list[i].handler(session);
                     break;
                 }
             }
         }
-        else {
+        else if (session->possible_escape_sequences_count > 1) {
             return; // We have few candidates for escape - wait next symbol
         }
     }
 
     // Reset escape state
-    incoming_escape_length = 0;
-    cli_state = CLI_STATE_DEFAULT;
-    for (int32_t i = 0; i < CLI_ESCAPE_SEQUENCES_COUNT; ++i) {
-        escape_list[i].is_exclude = false;
-    }
-    possible_escape_sequences_count = CLI_ESCAPE_SEQUENCES_COUNT;
+    session->incoming_escape_length = 0;
+    session->state = CLI_STATE_DEFAULT;
+    memset(session->escape_exclude, 0, sizeof(session->escape_exclude));
+    session->possible_escape_sequences_count = CLI_ESCAPE_SEQUENCES_COUNT;
 }
 
 //  ***************************************************************************
 /// @brief  Process state for receive command
+/// @param  session: CLI session context
 /// @param  symbol: received symbol
 /// @return none
 //  ***************************************************************************
-static void default_state_process(char symbol) {
+static void default_state_process(cli_session_t* session, char symbol) {
+    cli_cmd_info_t* current_cmd = &session->current_cmd;
 
-    if (cursor_pos < current_cmd.length) {
-        memmove(&current_cmd.cmd[cursor_pos + 1], &current_cmd.cmd[cursor_pos], current_cmd.length - cursor_pos); // Offset symbols after cursor
-        _send_data("\x1B[s"); // Save CLI cursor position
-        for (int32_t i = cursor_pos; i < current_cmd.length + 1; ++i) { // Replace old symbols
-            _send_data(&current_cmd.cmd[i]);
-        }
-        _send_data("\x1B[u"); // Save CLI cursor position
+    if ((uint8_t)symbol < 0x20 || current_cmd->length >= CLI_MAX_COMMAND_LENGTH - 1) {
+        return; // Unsupported control symbol or command buffer is full (last byte is reserved for null-terminator)
     }
-    current_cmd.cmd[cursor_pos] = symbol;
-    ++current_cmd.length;
-    ++cursor_pos;
-    
-    _send_data(&symbol);
+
+    memmove(&current_cmd->cmd[session->cursor_pos + 1], &current_cmd->cmd[session->cursor_pos], current_cmd->length - session->cursor_pos); // Offset symbols after cursor
+    current_cmd->cmd[session->cursor_pos] = symbol;
+    ++current_cmd->length;
+
+    send_data(session, &current_cmd->cmd[session->cursor_pos]); // Print new symbol and replace old symbols after cursor
+    ++session->cursor_pos;
+    send_cursor_left(session, current_cmd->length - session->cursor_pos); // Restore cursor position
 }
 
 
@@ -216,203 +560,851 @@ static void default_state_process(char symbol) {
 
 //  ***************************************************************************
 /// @brief  Process '\r' and '\n' escapes
-/// @param  none
+/// @param  session: CLI session context
+/// @return none
+//  ***************************************************************************
+static void escape_return_handler(cli_session_t* session) {
+
+    send_data(session, "\r\n");
+
+    // Put command to history and reset history navigation
+    history_put(session, &session->current_cmd);
+    session->history_pos = -1;
+
+    // Clear buffer to new command
+    cli_cmd_info_t cmd = session->current_cmd;
+    memset(&session->current_cmd, 0, sizeof(session->current_cmd));
+    session->cursor_pos = 0;
+
+    execute_command(session, &cmd);
+    if (session->running_cmd == NULL) {
+        send_data(session, CLI_GREETING_STRING);
+    }
+}
+
+//  ***************************************************************************
+/// @brief  Process BACKSPACE escape
+/// @param  session: CLI session context
 /// @return none
 //  ***************************************************************************
-static void escape_return_handler(void) {
+static void escape_backspace_handler(cli_session_t* session) {
+    cli_cmd_info_t* current_cmd = &session->current_cmd;
 
-    _send_data("\r\n");
-    if (strcmp(current_cmd.cmd, "hello") == 0) {
-        _send_data(CLI_GREETING_STRING);
+    if (session->is_search) {
+        if (session->search_pattern.length > 0) {
+            session->search_pattern.cmd[--session->search_pattern.length] = 0;
+            search_update(session, -1); // Pattern is shorter - search again from newest command
+        }
         return;
     }
 
-    if (cmd_history_length >= CLI_MAX_COMMAND_HISTORY_LENGTH) { // History buffer overflow - remove first command and offset array to begin
-        memmove(&cmd_history[0], &cmd_history[1], sizeof(cmd_history) - sizeof(cmd_history[0]));
-        cmd_history_length = CLI_MAX_COMMAND_HISTORY_LENGTH - 1;
+    if (session->cursor_pos > 0) {
+        memmove(&current_cmd->cmd[session->cursor_pos - 1], &current_cmd->cmd[session->cursor_pos], current_cmd->length - session->cursor_pos); // Remove symbol from buffer
+        current_cmd->cmd[current_cmd->length - 1] = 0; // Clear last symbol
+        --current_cmd->length;                     // Decreate command size
+        --session->cursor_pos;                     // Shift cursor to left
+
+        send_data(session, "\x7F\x1B[s"); // Remove symbol and save CLI cursor position
+        send_data(session, &current_cmd->cmd[session->cursor_pos]); // Replace old symbols
+        send_data(session, " \x1B[u");    // Hide last symbol and restore CLI cursor position
     }
+}
 
-    // Put command to history
-    cmd_history[cmd_history_length] = current_cmd;
-    ++cmd_history_length;
+//  ***************************************************************************
+/// @brief  Process DELETE escapes
+/// @param  session: CLI session context
+/// @return none
+//  ***************************************************************************
+static void escape_del_handler(cli_session_t* session) {
+    cli_cmd_info_t* current_cmd = &session->current_cmd;
 
-    // Move history cursor to last command
-    cmd_history_pos = cmd_history_length;
+    if (session->cursor_pos < current_cmd->length) {
+        memmove(&current_cmd->cmd[session->cursor_pos], &current_cmd->cmd[session->cursor_pos + 1], current_cmd->length - session->cursor_pos); // Remove symbol from buffer
+        current_cmd->cmd[current_cmd->length] = 0; // Clear last symbol
+        --current_cmd->length;                     // Decreate command size
 
-    // Clear buffer to new command
-    memset(&current_cmd, 0, sizeof(current_cmd));
-    cursor_pos = 0;
+        send_data(session, "\x1B[s"); // Save CLI cursor position
+        send_data(session, &current_cmd->cmd[session->cursor_pos]);
+        send_data(session, " \x1B[u"); // Hide last symbol and restore CLI cursor position
+    }
+}
+
+//  ***************************************************************************
+/// @brief  Process ARROW_UP escape
+/// @note   Search previous command which begins with command typed before navigation
+/// @param  session: CLI session context
+/// @return none
+//  ***************************************************************************
+static void escape_up_handler(cli_session_t* session) {
+
+    if (session->history_pos < 0) {
+        session->history_prefix = session->current_cmd; // Start navigation - remember typed command
+    }
+
+    int32_t pos = history_find(session, history_prev(session, session->history_pos), &session->history_prefix, true, true);
+    if (pos < 0) {
+        return; // No more commands
+    }
 
-    _send_data(CLI_GREETING_STRING);
+    cli_cmd_info_t cmd;
+    history_get(session, pos, &cmd);
+    replace_command(session, &cmd);
+    session->history_pos = pos;
 }
 
 //  ***************************************************************************
-/// @brief  Process BACKSPACE escape
-/// @param  none
+/// @brief  Process ARROW_DOWN escape
+/// @note   Search next command which begins with command typed before navigation
+/// @param  session: CLI session context
 /// @return none
 //  ***************************************************************************
-static void escape_backspace_handler(void) {
+static void escape_down_handler(cli_session_t* session) {
+
+    if (session->history_pos < 0) {
+        return; // Navigation is not active
+    }
+
+    int32_t pos = history_find(session, history_next(session, session->history_pos), &session->history_prefix, true, false);
+    if (pos < 0) {
+        replace_command(session, &session->history_prefix); // End of history - restore typed command
+        session->history_pos = -1;
+        return;
+    }
+
+    cli_cmd_info_t cmd;
+    history_get(session, pos, &cmd);
+    replace_command(session, &cmd);
+    session->history_pos = pos;
+}
 
-    if (cursor_pos > 0) {
-        memmove(&current_cmd.cmd[cursor_pos - 1], &current_cmd.cmd[cursor_pos], current_cmd.length - cursor_pos); // Remove symbol from buffer
-        current_cmd.cmd[current_cmd.length - 1] = 0; // Clear last symbol
-        --current_cmd.length;                    // Decreate command size
-        --cursor_pos;                            // Shift cursor to left
-        
-        _send_data("\x7F\x1B[s"); // Remove symbol and save CLI cursor position
-        _send_data(&current_cmd.cmd[cursor_pos]); // Replace old symbols
-        _send_data(" \x1B[u");    // Hide last symbol and restore CLI cursor position
+//  ***************************************************************************
+/// @brief  Process ARROW_LEFT escape
+/// @param  session: CLI session context
+/// @return none
+//  ***************************************************************************
+static void escape_left_handler(cli_session_t* session) {
+    if (session->cursor_pos > 0) {
+        send_data(session, "\x1B[D");
+        --session->cursor_pos;
     }
 }
 
 //  ***************************************************************************
-/// @brief  Process DELETE escapes
-/// @param  none
+/// @brief  Process ARROW_RIGHT escape
+/// @param  session: CLI session context
 /// @return none
 //  ***************************************************************************
-static void escape_del_handler(void) {
+static void escape_right_handler(cli_session_t* session) {
+    if (session->cursor_pos < session->current_cmd.length) {
+        send_data(session, "\x1B[C");
+        ++session->cursor_pos;
+    }
+}
 
-    if (cursor_pos < current_cmd.length) {
-        memmove(&current_cmd.cmd[cursor_pos], &current_cmd.cmd[cursor_pos + 1], current_cmd.length - cursor_pos); // Remove symbol from buffer
-        current_cmd.cmd[current_cmd.length] = 0; // Clear last symbol
-        --current_cmd.length;                    // Decreate command size
-        
-        _send_data("\x1B[s"); // Save CLI cursor position
-        _send_data(&current_cmd.cmd[cursor_pos]);
-        _send_data(" \x1B[u"); // Hide last symbol and restore CLI cursor position
+//  ***************************************************************************
+/// @brief  Process HOME escape
+/// @param  session: CLI session context
+/// @return none
+//  ***************************************************************************
+static void escape_home_handler(cli_session_t* session) {
+    while (session->cursor_pos > 0) {
+        send_data(session, "\x1B[D");
+        --session->cursor_pos;
     }
 }
 
 //  ***************************************************************************
-/// @brief  Process ARROW_UP escape
-/// @param  none
+/// @brief  Process END escape
+/// @param  session: CLI session context
+/// @return none
+//  ***************************************************************************
+static void escape_end_handler(cli_session_t* session) {
+    while (session->cursor_pos < session->current_cmd.length) {
+        send_data(session, "\x1B[C");
+        ++session->cursor_pos;
+    }
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Process CTRL+R escape (reverse incremental search)
+/// @param  session: CLI session context
+/// @return none
+//  ***************************************************************************
+static void escape_search_handler(cli_session_t* session) {
+
+    if (!session->is_search) {
+        session->is_search = true;
+        session->is_search_failed = false;
+        session->search_pos = -1;
+        memset(&session->search_pattern, 0, sizeof(session->search_pattern));
+        search_update(session, -1);
+        return;
+    }
+
+    // Search next older command. Empty pattern matches any command: walk history from newest command
+    int32_t start_pos = -1;
+    if (session->search_pos >= 0) {
+        start_pos = history_prev(session, session->search_pos);
+    }
+    else if (session->search_pattern.length == 0) {
+        start_pos = history_prev(session, -1);
+    }
+    if (start_pos < 0) {
+        session->is_search_failed = true;
+        search_update(session, -2);
+        return;
+    }
+    search_update(session, start_pos);
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Process TAB escape (command completion)
+/// @note   Double TAB prints candidates if completion is ambiguous
+/// @param  session: CLI session context
 /// @return none
 //  ***************************************************************************
-static void escape_up_handler(void) {
+static void escape_tab_handler(cli_session_t* session) {
+    cli_cmd_info_t* current_cmd = &session->current_cmd;
+
+    if (session->cursor_pos != current_cmd->length) {
+        return; // Complete only at end of command
+    }
+
+    // Search node for typed text - O(text length)
+    uint16_t node = 0;
+    for (int32_t i = 0; i < current_cmd->length; ++i) {
+        node = trie_find_child(node, current_cmd->cmd[i]);
+        if (node == 0) {
+            send_data(session, "\x07"); // Unknown command or argument
+            return;
+        }
+    }
+
+    // Complete while way is unique
+    int32_t prev_length = current_cmd->length;
+    while (current_cmd->length < CLI_MAX_COMMAND_LENGTH - 1) {
+        uint16_t child = trie_nodes[node].child;
+        if (child == 0 || trie_nodes[child].sibling != 0) {
+            break; // No children or few candidates
+        }
+        if (trie_nodes[node].is_terminal && trie_nodes[child].symbol != ' ') {
+            break; // Node is complete word and also begin of longer word
+        }
+        current_cmd->cmd[current_cmd->length++] = trie_nodes[child].symbol;
+        node = child;
+        if (trie_nodes[node].symbol == ' ') {
+            break; // Complete one word per TAB
+        }
+    }
+    if (trie_nodes[node].is_terminal && trie_nodes[node].child == 0 && current_cmd->length < CLI_MAX_COMMAND_LENGTH - 1) {
+        current_cmd->cmd[current_cmd->length++] = ' '; // Last word is complete
+    }
 
-    --cmd_history_pos;
-    if (cmd_history_pos < 0) {
-        cmd_history_pos = 0;
+    if (current_cmd->length != prev_length) {
+        send_data(session, &current_cmd->cmd[prev_length]);
+        session->cursor_pos = current_cmd->length;
+        session->is_completion_ambiguous = false;
+        return;
     }
 
-    // Calculate diff between current command and command from history
-    int32_t remainder = current_cmd.length - cmd_history[cmd_history_pos].length;
+    if (!session->is_completion_ambiguous) {
+        session->is_completion_ambiguous = true;
+        return; // Wait second TAB
+    }
 
-    // Move cursor to begin of command
-    while (current_cmd.length) {
-        _send_data("\x1B[D");
-        --current_cmd.length;
-        --cursor_pos;
+    // Print candidates for current word and restore command line
+    char word[CLI_MAX_COMMAND_LENGTH] = {0};
+    int32_t word_begin = current_cmd->length;
+    while (word_begin > 0 && current_cmd->cmd[word_begin - 1] != ' ') {
+        --word_begin;
     }
+    memcpy(word, &current_cmd->cmd[word_begin], current_cmd->length - word_begin);
+
+    send_data(session, "\r\n");
+    trie_print_candidates(session, node, word, current_cmd->length - word_begin);
+    send_data(session, "\r\n");
+    send_data(session, CLI_GREETING_STRING);
+    send_data(session, current_cmd->cmd);
+}
+
+//  ***************************************************************************
+/// @brief  Process CTRL+C escape (command is not running)
+/// @param  session: CLI session context
+/// @return none
+//  ***************************************************************************
+static void escape_cancel_handler(cli_session_t* session) {
+    session->is_search = false;
+    session->is_search_failed = false;
+    session->search_pos = -1;
+    session->history_pos = -1;
+
+    // Drop current command
+    memset(&session->current_cmd, 0, sizeof(session->current_cmd));
+    session->cursor_pos = 0;
+
+    send_data(session, "^C\r\n");
+    send_data(session, CLI_GREETING_STRING);
+}
+
+
+
 
-    // Print new command
-    current_cmd = cmd_history[cmd_history_pos];
-    _send_data(current_cmd.cmd);
-    cursor_pos += current_cmd.length;
-        
-    // Clear others symbols
-    _send_data("\x1B[s"); // Save CLI cursor position
-    for (int32_t i = 0; i < remainder; ++i) {
-        _send_data(" ");
+
+//  ***************************************************************************
+/// @brief  Process state for receive search pattern
+/// @param  session: CLI session context
+/// @param  symbol: received symbol
+/// @return none
+//  ***************************************************************************
+static void search_state_process(cli_session_t* session, char symbol) {
+
+    if ((uint8_t)symbol < 0x20 || session->search_pattern.length >= CLI_MAX_COMMAND_LENGTH - 1) {
+        return; // Unsupported control symbol or pattern buffer is full
     }
-    _send_data("\x1B[u"); // Restore CLI cursor position
+    session->search_pattern.cmd[session->search_pattern.length++] = symbol;
+
+    // Current found command can also match to longer pattern - search from it
+    search_update(session, session->search_pos);
 }
 
 //  ***************************************************************************
-/// @brief  Process ARROW_DOWN escape
-/// @param  none
+/// @brief  Search command by pattern and redraw search line
+/// @param  session: CLI session context
+/// @param  start_pos: record offset for start search, -1 - start from newest command (empty pattern - do not
+///         search), -2 - do not search
+/// @return none
+//  ***************************************************************************
+static void search_update(cli_session_t* session, int32_t start_pos) {
+
+    if (start_pos >= 0 || (start_pos == -1 && session->search_pattern.length > 0)) {
+        if (start_pos < 0) {
+            start_pos = history_prev(session, -1);
+        }
+        int32_t pos = history_find(session, start_pos, &session->search_pattern, false, true);
+        session->is_search_failed = (pos < 0);
+        if (pos >= 0) {
+            session->search_pos = pos;
+            history_get(session, pos, &session->current_cmd);
+        }
+    }
+
+    // Redraw line: (reverse-i-search)`pattern': command
+    send_data(session, session->is_search_failed ? "\r(failed reverse-i-search)`" : "\r(reverse-i-search)`");
+    send_data(session, session->search_pattern.cmd);
+    send_data(session, "': ");
+    send_data(session, session->current_cmd.cmd);
+    send_data(session, "\x1B[K");
+    session->cursor_pos = session->current_cmd.length;
+}
+
+//  ***************************************************************************
+/// @brief  Finish reverse incremental search and accept found command
+/// @param  session: CLI session context
+/// @return none
+//  ***************************************************************************
+static void search_finish(cli_session_t* session) {
+    session->is_search = false;
+    session->is_search_failed = false;
+    session->search_pos = -1;
+    session->history_pos = -1;
+
+    send_data(session, "\r");
+    send_data(session, CLI_GREETING_STRING);
+    send_data(session, session->current_cmd.cmd);
+    send_data(session, "\x1B[K");
+    session->cursor_pos = session->current_cmd.length;
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Put command to history
+/// @note   Oldest records are dropped until new record fit to arena
+/// @param  session: CLI session context
+/// @param  cmd: command for put
+/// @return none
+//  ***************************************************************************
+static void history_put(cli_session_t* session, const cli_cmd_info_t* cmd) {
+
+    int32_t record_size = cmd->length + 2;
+    if (cmd->length == 0 || record_size > CLI_HISTORY_BUFFER_SIZE) {
+        return; // Don't save empty commands
+    }
+
+    while (session->history_used + record_size > CLI_HISTORY_BUFFER_SIZE) { // Remove oldest records
+        int32_t oldest_size = (uint8_t)session->history[session->history_begin] + 2;
+        session->history_begin = (session->history_begin + oldest_size) % CLI_HISTORY_BUFFER_SIZE;
+        session->history_used -= oldest_size;
+    }
+
+    // Write record: [length][command][length]
+    int32_t offset = session->history_end;
+    session->history[offset] = (char)cmd->length;
+    for (int32_t i = 0; i < cmd->length; ++i) {
+        offset = (offset + 1) % CLI_HISTORY_BUFFER_SIZE;
+        session->history[offset] = cmd->cmd[i];
+    }
+    offset = (offset + 1) % CLI_HISTORY_BUFFER_SIZE;
+    session->history[offset] = (char)cmd->length;
+
+    session->history_end = (offset + 1) % CLI_HISTORY_BUFFER_SIZE;
+    session->history_used += record_size;
+}
+
+//  ***************************************************************************
+/// @brief  Get previous (older) history record
+/// @param  session: CLI session context
+/// @param  pos: record offset, -1 - after newest record
+/// @return previous record offset, -1 - no more records
+//  ***************************************************************************
+static int32_t history_prev(cli_session_t* session, int32_t pos) {
+    if (session->history_used == 0 || pos == session->history_begin) {
+        return -1;
+    }
+    if (pos < 0) {
+        pos = session->history_end;
+    }
+    int32_t length = (uint8_t)session->history[(pos + CLI_HISTORY_BUFFER_SIZE - 1) % CLI_HISTORY_BUFFER_SIZE];
+    return (pos + CLI_HISTORY_BUFFER_SIZE - length - 2) % CLI_HISTORY_BUFFER_SIZE;
+}
+
+//  ***************************************************************************
+/// @brief  Get next (newer) history record
+/// @param  session: CLI session context
+/// @param  pos: record offset
+/// @return next record offset, -1 - no more records
+//  ***************************************************************************
+static int32_t history_next(cli_session_t* session, int32_t pos) {
+    if (pos < 0) {
+        return -1;
+    }
+    int32_t length = (uint8_t)session->history[pos];
+    pos = (pos + length + 2) % CLI_HISTORY_BUFFER_SIZE;
+    return (pos == session->history_end) ? -1 : pos;
+}
+
+//  ***************************************************************************
+/// @brief  Find history record which contains pattern
+/// @note   Search time is bounded by history arena size
+/// @param  session: CLI session context
+/// @param  pos: record offset for start search (record is included to search)
+/// @param  pattern: pattern for search
+/// @param  is_prefix: true - record should begin with pattern, false - record should contain pattern
+/// @param  is_backward: true - search to older records, false - search to newer records
+/// @return found record offset, -1 - record not found
+//  ***************************************************************************
+static int32_t history_find(cli_session_t* session, int32_t pos, const cli_cmd_info_t* pattern, bool is_prefix, bool is_backward) {
+
+    while (pos >= 0) {
+        int32_t length = (uint8_t)session->history[pos];
+        int32_t last_offset = is_prefix ? 0 : length - pattern->length;
+        for (int32_t offset = 0; offset <= last_offset; ++offset) {
+            int32_t i = 0;
+            while (i < pattern->length && session->history[(pos + 1 + offset + i) % CLI_HISTORY_BUFFER_SIZE] == pattern->cmd[i]) {
+                ++i;
+            }
+            if (i == pattern->length) {
+                return pos;
+            }
+        }
+        pos = is_backward ? history_prev(session, pos) : history_next(session, pos);
+    }
+    return -1;
+}
+
+//  ***************************************************************************
+/// @brief  Get command from history record
+/// @param  session: CLI session context
+/// @param  pos: record offset
+/// @param  cmd: buffer for command
+/// @return none
+//  ***************************************************************************
+static void history_get(cli_session_t* session, int32_t pos, cli_cmd_info_t* cmd) {
+    memset(cmd, 0, sizeof(cli_cmd_info_t));
+    cmd->length = (uint8_t)session->history[pos];
+    for (int32_t i = 0; i < cmd->length; ++i) {
+        cmd->cmd[i] = session->history[(pos + 1 + i) % CLI_HISTORY_BUFFER_SIZE];
+    }
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Find command in registry and call it handler
+/// @param  session: CLI session context
+/// @param  cmd: command line
+/// @return none
+//  ***************************************************************************
+static void execute_command(cli_session_t* session, const cli_cmd_info_t* cmd) {
+
+    // Split command line to arguments
+    memset(session->cmd_args, 0, sizeof(session->cmd_args));
+    memset(session->cmd_argv, 0, sizeof(session->cmd_argv));
+    session->cmd_argc = 0;
+    memcpy(session->cmd_args, cmd->cmd, sizeof(session->cmd_args) - 1);
+    for (char* p = session->cmd_args; *p != 0; ++p) {
+        if (*p == ' ') {
+            *p = 0;
+        }
+        else if (p == session->cmd_args || *(p - 1) == 0) {
+            if (session->cmd_argc >= CLI_MAX_ARGUMENTS_COUNT) {
+                cli_core_send(session, "Too many arguments\r\n");
+                return;
+            }
+            session->cmd_argv[session->cmd_argc++] = p;
+        }
+    }
+    if (session->cmd_argc == 0) {
+        return; // Empty command
+    }
+
+    // Search command name in trie
+    uint16_t node = 0;
+    for (char* p = session->cmd_argv[0]; *p != 0; ++p) {
+        node = trie_find_child(node, *p);
+        if (node == 0) {
+            break;
+        }
+    }
+    if (node == 0 || !trie_nodes[node].is_terminal) {
+        cli_core_send(session, "Unknown command\r\n");
+        return;
+    }
+
+    // Command is executed from cli_core_process()
+    ++session->stats.started_commands;
+    TRACE_EVENT(TRACE_EVENT_CLI_CMD_BEGIN, trie_nodes[node].cmd_index);
+    session->running_cmd = &registered_cmd_list[trie_nodes[node].cmd_index];
+    session->is_cmd_cancelled = false;
+    session->cmd_step = 0;
+    memset(session->cmd_data, 0, sizeof(session->cmd_data));
+}
+
+//  ***************************************************************************
+/// @brief  Finish running command and process queued symbols
+/// @param  session: CLI session context
 /// @return none
 //  ***************************************************************************
-static void escape_down_handler(void) {
+static void finish_command(cli_session_t* session) {
+    TRACE_EVENT(TRACE_EVENT_CLI_CMD_END, session->running_cmd - registered_cmd_list);
+    session->running_cmd = NULL;
+    session->is_cmd_cancelled = false;
 
-    ++cmd_history_pos;
-    if (cmd_history_pos > cmd_history_length) {
-        cmd_history_pos = cmd_history_length;
+    if (session->is_frame_request) {
+        session->frame_tx[1] = CLI_FRAME_STATUS_DONE;
+        frame_send(session, session->frame_tx, session->frame_tx_length);
+        session->is_frame_request = false;
+    }
+    if (session->is_machine_mode) {
+        frame_request_process(session);
+        return;
     }
+    send_data(session, CLI_GREETING_STRING);
 
-    int32_t remainder = 0;
-    if (cmd_history_pos < cmd_history_length) {
+    // Process symbols received while command was running. Stop if new command is started
+    while (session->input_queue_length > 0 && session->running_cmd == NULL) {
+        char symbol = session->input_queue[session->input_queue_head];
+        session->input_queue_head = (session->input_queue_head + 1) % CLI_INPUT_QUEUE_SIZE;
+        --session->input_queue_length;
+        symbol_process(session, symbol);
+    }
+}
 
-        // Calculate diff between current command and command from history
-        remainder = current_cmd.length - cmd_history[cmd_history_pos].length;
-    
-        // Move cursor to begin of command
-        while (current_cmd.length > 0) {
-            _send_data("\x1B[D");
-            --current_cmd.length;
-            --cursor_pos;
+//  ***************************************************************************
+/// @brief  Process received symbol in machine mode (COBS decoder)
+/// @param  session: CLI session context
+/// @param  symbol: received symbol
+/// @return none
+//  ***************************************************************************
+static void frame_symbol_process(cli_session_t* session, uint8_t symbol) {
+
+    if (symbol != 0x00) {
+        if (session->frame_rx_length >= CLI_FRAME_MAX_SIZE) {
+            session->is_frame_rx_overflow = true;
+            return;
         }
-    
-        // Print new command
-        current_cmd = cmd_history[cmd_history_pos];
-        _send_data(current_cmd.cmd);
-        cursor_pos += current_cmd.length;
+        session->frame_rx[session->frame_rx_length++] = symbol;
+        return;
+    }
+
+    // Frame delimiter - decode frame in place
+    int32_t encoded_length = session->frame_rx_length;
+    bool is_overflow = session->is_frame_rx_overflow;
+    session->frame_rx_length = 0;
+    session->is_frame_rx_overflow = false;
+    if (encoded_length == 0 || is_overflow) {
+        return; // Empty frame or frame is too long
     }
-    else {
-        remainder = current_cmd.length;
 
-        // Move cursor to begin of command
-        while (current_cmd.length > 0) {
-            _send_data("\x1B[D");
-            --current_cmd.length;
-            --cursor_pos;
+    uint8_t* data = session->frame_rx;
+    int32_t read_pos = 0;
+    int32_t length = 0;
+    while (read_pos < encoded_length) {
+        uint8_t code = data[read_pos++];
+        if (read_pos + code - 1 > encoded_length) {
+            return; // Bad COBS code
         }
+        for (int32_t i = 1; i < code; ++i) {
+            data[length++] = data[read_pos++];
+        }
+        if (code != 0xFF && read_pos < encoded_length) {
+            data[length++] = 0x00;
+        }
+    }
+    if (length < 3) {
+        return; // Frame is too short for contain request ID and CRC
+    }
 
-        memset(&current_cmd, 0, sizeof(current_cmd));
+    // Check frame
+    uint8_t response[4] = { data[0], CLI_FRAME_STATUS_BAD_FRAME };
+    uint16_t crc = (uint16_t)(data[length - 2] | (data[length - 1] << 8));
+    int32_t cmd_length = length - 3;
+    if (crc != frame_calc_crc(data, length - 2) || cmd_length >= CLI_MAX_COMMAND_LENGTH || memchr(&data[1], 0x00, cmd_length) != NULL) {
+        frame_send(session, response, 2);
+        return;
+    }
+    if (cmd_length == 1 && data[1] == CLI_FRAME_CANCEL_SYMBOL) { // Cancel running command on next cli_core_process() call
+        response[1] = (session->running_cmd != NULL) ? CLI_FRAME_STATUS_DONE : CLI_FRAME_STATUS_ERROR;
+        session->is_cmd_cancelled = (session->running_cmd != NULL);
+        frame_send(session, response, 2);
+        return;
     }
+    if (session->request_queue_length >= CLI_FRAME_QUEUE_SIZE) {
+        response[1] = CLI_FRAME_STATUS_BUSY;
+        frame_send(session, response, 2);
+        return;
+    }
+
+    // Put request to queue
+    int32_t index = (session->request_queue_head + session->request_queue_length) % CLI_FRAME_QUEUE_SIZE;
+    session->request_queue_id[index] = data[0];
+    memset(&session->request_queue[index], 0, sizeof(session->request_queue[index]));
+    memcpy(session->request_queue[index].cmd, &data[1], cmd_length);
+    session->request_queue[index].length = cmd_length;
+    ++session->request_queue_length;
 
-    // Clear others symbols
-    _send_data("\x1B[s"); // Save CLI cursor position
-    for (int32_t i = 0; i < remainder; ++i) {
-        _send_data(" ");
+    frame_request_process(session);
+}
+
+//  ***************************************************************************
+/// @brief  Start queued requests while no command is running
+/// @param  session: CLI session context
+/// @return none
+//  ***************************************************************************
+static void frame_request_process(cli_session_t* session) {
+    while (session->request_queue_length > 0 && session->running_cmd == NULL && session->is_machine_mode) {
+        int32_t index = session->request_queue_head;
+        session->request_queue_head = (session->request_queue_head + 1) % CLI_FRAME_QUEUE_SIZE;
+        --session->request_queue_length;
+        frame_start_request(session, session->request_queue_id[index], &session->request_queue[index]);
     }
-    _send_data("\x1B[u"); // Restore CLI cursor position
 }
 
 //  ***************************************************************************
-/// @brief  Process ARROW_LEFT escape
-/// @param  none
+/// @brief  Start command from request frame
+/// @param  session: CLI session context
+/// @param  request_id: request ID
+/// @param  cmd: command line
 /// @return none
 //  ***************************************************************************
-static void escape_left_handler(void) {
-    if (cursor_pos > 0) {
-        _send_data("\x1B[D");
-        --cursor_pos;
+static void frame_start_request(cli_session_t* session, uint8_t request_id, const cli_cmd_info_t* cmd) {
+    session->is_frame_request = true;
+    session->frame_tx[0] = request_id;
+    session->frame_tx_length = 2;
+
+    if (cmd->length == 0) { // Exit request - switch to interactive mode (queued requests are dropped)
+        session->frame_tx[1] = CLI_FRAME_STATUS_DONE;
+        frame_send(session, session->frame_tx, session->frame_tx_length);
+        session->is_frame_request = false;
+        cli_core_set_machine_mode(session, false);
+        send_data(session, CLI_GREETING_STRING);
+        return;
+    }
+
+    execute_command(session, cmd);
+    if (session->running_cmd == NULL) { // Command is not started
+        session->frame_tx[1] = CLI_FRAME_STATUS_ERROR;
+        frame_send(session, session->frame_tx, session->frame_tx_length);
+        session->is_frame_request = false;
     }
 }
 
 //  ***************************************************************************
-/// @brief  Process ARROW_RIGHT escape
-/// @param  none
+/// @brief  Add CRC to frame, encode it (COBS) and send
+/// @param  session: CLI session context
+/// @param  frame: frame data (should have 2 free bytes after data for CRC)
+/// @param  length: frame data length
 /// @return none
 //  ***************************************************************************
-static void escape_right_handler(void) {
-    if (cursor_pos < current_cmd.length) {
-        _send_data("\x1B[C");
-        ++cursor_pos;
+static void frame_send(cli_session_t* session, uint8_t* frame, int32_t length) {
+    uint16_t crc = frame_calc_crc(frame, length);
+    frame[length++] = (uint8_t)(crc & 0xFF);
+    frame[length++] = (uint8_t)(crc >> 8);
+
+    uint8_t encoded[CLI_FRAME_MAX_SIZE + CLI_FRAME_MAX_SIZE / 254 + 2];
+    int32_t code_pos = 0;
+    int32_t encoded_length = 1;
+    uint8_t code = 1;
+    for (int32_t i = 0; i < length; ++i) {
+        if (frame[i] != 0x00) {
+            encoded[encoded_length++] = frame[i];
+            ++code;
+        }
+        if (frame[i] == 0x00 || code == 0xFF) {
+            encoded[code_pos] = code;
+            code_pos = encoded_length++;
+            code = 1;
+        }
     }
+    encoded[code_pos] = code;
+    encoded[encoded_length++] = 0x00; // Frame delimiter
+
+    ++session->stats.tx_frames;
+    session->stats.tx_frame_bytes += encoded_length;
+    session->send_frame(session->context, encoded, encoded_length);
 }
 
 //  ***************************************************************************
-/// @brief  Process HOME escape
-/// @param  none
+/// @brief  Calculate CRC16-CCITT (poly 0x1021, init 0xFFFF)
+/// @param  data: data for calculate
+/// @param  length: data length
+/// @return CRC value
+//  ***************************************************************************
+static uint16_t frame_calc_crc(const uint8_t* data, int32_t length) {
+    uint16_t crc = 0xFFFF;
+    while (length--) {
+        crc ^= (uint16_t)(*data++ << 8);
+        for (int32_t i = 0; i < 8; ++i) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+//  ***************************************************************************
+/// @brief  Insert text to completion trie
+/// @param  node: node index for insert text after it
+/// @param  text: text for insert
+/// @return last text node index, 0 - nodes pool is overflow
+//  ***************************************************************************
+static uint16_t trie_insert(uint16_t node, const char* text) {
+    for (; *text != 0; ++text) {
+        uint16_t child = trie_find_child(node, *text);
+        if (child == 0) {
+            if (trie_nodes_count >= CLI_TRIE_MAX_NODES) {
+                return 0;
+            }
+            child = trie_nodes_count++;
+            trie_nodes[child].symbol = *text;
+
+            // Append node to end of children list for keep registration order
+            uint16_t* link = &trie_nodes[node].child;
+            while (*link != 0) {
+                link = &trie_nodes[*link].sibling;
+            }
+            *link = child;
+        }
+        node = child;
+    }
+    return node;
+}
+
+//  ***************************************************************************
+/// @brief  Find child node by symbol
+/// @param  node: parent node index
+/// @param  symbol: child node symbol
+/// @return child node index, 0 - not found
+//  ***************************************************************************
+static uint16_t trie_find_child(uint16_t node, char symbol) {
+    for (uint16_t child = trie_nodes[node].child; child != 0; child = trie_nodes[child].sibling) {
+        if (trie_nodes[child].symbol == symbol) {
+            return child;
+        }
+    }
+    return 0;
+}
+
+//  ***************************************************************************
+/// @brief  Print all words which can be completed from node
+/// @param  session: CLI session context
+/// @param  node: node index
+/// @param  word: word buffer (contains typed part of word)
+/// @param  word_length: current word length
 /// @return none
 //  ***************************************************************************
-static void escape_home_handler(void) {
-    while (cursor_pos > 0) {
-        _send_data("\x1B[D");
-        --cursor_pos;
+static void trie_print_candidates(cli_session_t* session, uint16_t node, char* word, int32_t word_length) {
+    if (trie_nodes[node].is_terminal) {
+        word[word_length] = 0;
+        send_data(session, word);
+        send_data(session, "  ");
+    }
+    if (word_length >= CLI_MAX_COMMAND_LENGTH - 1) {
+        return;
     }
+    for (uint16_t child = trie_nodes[node].child; child != 0; child = trie_nodes[child].sibling) {
+        if (trie_nodes[child].symbol == ' ') {
+            continue; // Don't print arguments of command
+        }
+        word[word_length] = trie_nodes[child].symbol;
+        trie_print_candidates(session, child, word, word_length + 1);
+    }
+    word[word_length] = 0;
 }
 
 //  ***************************************************************************
-/// @brief  Process END escape
-/// @param  none
+/// @brief  Replace current command in terminal
+/// @param  session: CLI session context
+/// @param  cmd: new command
 /// @return none
 //  ***************************************************************************
-static void escape_end_handler(void) {
-    while (cursor_pos < current_cmd.length) {
-        _send_data("\x1B[C");
-        ++cursor_pos;
+static void replace_command(cli_session_t* session, const cli_cmd_info_t* cmd) {
+    send_cursor_left(session, session->cursor_pos); // Move cursor to begin of command
+
+    session->current_cmd = *cmd;
+    send_data(session, session->current_cmd.cmd);
+    send_data(session, "\x1B[K"); // Clear others symbols
+    session->cursor_pos = session->current_cmd.length;
+}
+
+//  ***************************************************************************
+/// @brief  Move terminal cursor to left
+/// @param  session: CLI session context
+/// @param  count: columns count
+/// @return none
+//  ***************************************************************************
+static void send_cursor_left(cli_session_t* session, int32_t count) {
+    if (count <= 0) {
+        return;
     }
+
+    // Make ESC[<count>D sequence
+    char escape[16] = "\x1B[";
+    char* p = cli_core_format_dec(&escape[2], count);
+    *p++ = 'D';
+    *p = 0;
+    send_data(session, escape);
+}
+
+//  ***************************************************************************
+/// @brief  Send data to session terminal
+/// @param  session: CLI session context
+/// @param  data: null-terminated string for send
+/// @return none
+//  ***************************************************************************
+static void send_data(cli_session_t* session, const char* data) {
+    ++session->stats.tx_calls;
+    session->stats.tx_bytes += strlen(data);
+    session->send_data(session->context, data);
 }
@@ -5,12 +5,153 @@
 //  ***************************************************************************
 #ifndef _CLI_CORE_H_
 #define _CLI_CORE_H_
+#include <stdint.h>
+#include <stdbool.h>
 
+#define CLI_HISTORY_BUFFER_SIZE                 (512)   // Command history arena size in bytes
+#define CLI_MAX_COMMAND_LENGTH                  (64)
+#define CLI_MAX_ESCAPE_LENGTH                   (10)
+#define CLI_ESCAPE_SEQUENCES_COUNT              (14)
+#define CLI_MAX_ARGUMENTS_COUNT                 (8)     // Max command arguments count (including command name)
+#define CLI_TRIE_MAX_NODES                      (256)   // Completion trie size (nodes count)
+#define CLI_INPUT_QUEUE_SIZE                    (64)    // Queue size for symbols received while command is running
+#define CLI_FRAME_MAX_SIZE                      (128)   // Max decoded frame size in machine mode (including header and CRC)
+#define CLI_FRAME_QUEUE_SIZE                    (4)     // Max pipelined requests count in machine mode
+#define CLI_CMD_DATA_SIZE                       (2)     // Running command private data size (32-bit words)
 
-extern void cli_core_init(void(*send_data)(const char*));
-extern void cli_core_reset(void);
-extern void cli_core_symbol_received(char symbol);
 
+// Machine mode preamble: switch session from interactive mode to machine mode. Preamble contains
+// 0xC0 and 0xC1 which are never valid in UTF-8 and can not be typed (telnet sends CR NUL for Enter)
+#define CLI_MACHINE_MODE_PREAMBLE               ("\x00\xC0\xC1\x00")
+#define CLI_MACHINE_MODE_PREAMBLE_LENGTH        (sizeof(CLI_MACHINE_MODE_PREAMBLE) - 1)
 
-#endif // _CLI_CORE_H_
 
+typedef struct cli_session cli_session_t;
+
+// Machine mode response status. Frame format (COBS encoded, 0x00 - frame delimiter):
+// Request:  [request id: 1 byte][command text][CRC16-CCITT: 2 bytes LE]
+// Response: [request id: 1 byte][status: 1 byte][command output][CRC16-CCITT: 2 bytes LE]
+// Request with empty command text switches session back to interactive mode (response status is DONE).
+// Cancel request (command text is single CLI_FRAME_CANCEL_SYMBOL, as Ctrl-C in interactive mode) is not
+// queued: running command is cancelled and finished with CANCELLED status, cancel request response
+// status is DONE (ERROR if no command is running)
+#define CLI_FRAME_CANCEL_SYMBOL                 (0x03)
+typedef enum {
+    CLI_FRAME_STATUS_MORE      = 0x00,                  // Partial command output, next frames follow
+    CLI_FRAME_STATUS_DONE      = 0x01,                  // Command is completed
+    CLI_FRAME_STATUS_ERROR     = 0x02,                  // Unknown command or bad arguments
+    CLI_FRAME_STATUS_BAD_FRAME = 0x03,                  // Request frame CRC or format error
+    CLI_FRAME_STATUS_BUSY      = 0x04,                  // Request queue is full
+    CLI_FRAME_STATUS_CANCELLED = 0x05                   // Command is cancelled by cancel request
+} cli_frame_status_t;
+
+typedef enum {
+    CLI_CMD_DONE,                                       // Command is completed
+    CLI_CMD_CONTINUE                                    // Command is not completed - call handler again
+} cli_cmd_status_t;
+
+// Command handler. argv[0] is command name
+// Handler should do limited work per call (e.g. send one output chunk) and return CLI_CMD_CONTINUE
+// for continue on next cli_core_process() call. session->cmd_step can be used for save progress
+typedef cli_cmd_status_t(*cli_cmd_handler_t)(cli_session_t* session, int32_t argc, char* argv[]);
+
+// Command description for command registry
+typedef struct {
+    const char* name;                                   // Command name (without spaces)
+    const char* const* args;                            // NULL-terminated argument enumeration for completion (can be NULL)
+    cli_cmd_handler_t handler;                          // Command handler
+} cli_cmd_t;
+
+typedef struct {
+    char cmd[CLI_MAX_COMMAND_LENGTH];
+    int32_t length;
+} cli_cmd_info_t;
+
+// Session statistics. Compare values before and after symbol processing for get per-keystroke cost
+typedef struct {
+    uint32_t rx_symbols;                                // Received symbols count
+    uint32_t tx_calls;                                  // Send data callback calls count
+    uint32_t tx_bytes;                                  // Bytes sent by send data callback
+    uint32_t tx_frames;                                 // Frames sent in machine mode
+    uint32_t tx_frame_bytes;                            // Bytes sent by send binary data callback
+    uint32_t started_commands;                          // Started commands count
+} cli_stats_t;
+
+// CLI session context. Each terminal (UART, USB-CDC, socket, etc.) uses own session
+struct cli_session {
+    void(*send_data)(void* context, const char* data); // Send data callback
+    void* context;                                      // User context for send data callback
+    bool(*is_tx_ready)(void* context);                  // TX ready callback (can be NULL)
+    void(*send_frame)(void* context, const uint8_t* data, uint32_t size); // Send binary data callback for machine mode (can be NULL)
+
+    int32_t state;                                      // Current CLI driver state
+    int32_t cursor_pos;                                 // Current cursor position (equal cursor position in terminal)
+    cli_cmd_info_t current_cmd;                         // Current command information: command text and length
+
+    char incoming_escape[CLI_MAX_ESCAPE_LENGTH];        // Buffer for escape sequences
+    int32_t incoming_escape_length;                     // Current escape sequence length
+    int32_t possible_escape_sequences_count;            // Escape sequences count which can match with incoming escape
+    bool escape_exclude[CLI_ESCAPE_SEQUENCES_COUNT];    // Excluded escape sequences flags
+
+    char history[CLI_HISTORY_BUFFER_SIZE];              // Command history ring arena: [length][command][length] records
+    int32_t history_begin;                              // Offset of oldest record
+    int32_t history_end;                                // Offset after newest record
+    int32_t history_used;                               // Used bytes in history arena
+    int32_t history_pos;                                // Offset of selected record (using for navigation), -1 - no selection
+    cli_cmd_info_t history_prefix;                      // Command prefix for history navigation (restored after navigation)
+
+    bool is_search;                                     // Reverse incremental search mode
+    bool is_search_failed;                              // Search pattern not found
+    int32_t search_pos;                                 // Offset of found record, -1 - no found record
+    cli_cmd_info_t search_pattern;                      // Reverse incremental search pattern
+
+    bool is_completion_ambiguous;                       // Previous TAB is not complete command (next TAB prints candidates)
+
+    const cli_cmd_t* running_cmd;                       // Running command, NULL - no running command
+    bool is_cmd_cancelled;                              // Running command is cancelled by CTRL+C
+    uint32_t cmd_step;                                  // Running command progress (handler private, zero on command start)
+    uint32_t cmd_data[CLI_CMD_DATA_SIZE];               // Running command data (handler private, zero on command start)
+    char cmd_args[CLI_MAX_COMMAND_LENGTH];              // Running command arguments buffer
+    char* cmd_argv[CLI_MAX_ARGUMENTS_COUNT];            // Running command arguments
+    int32_t cmd_argc;                                   // Running command arguments count
+
+    char input_queue[CLI_INPUT_QUEUE_SIZE];             // Symbols received while command is running
+    int32_t input_queue_head;                           // Input queue first symbol index
+    int32_t input_queue_length;                         // Input queue symbols count
+
+    int32_t preamble_length;                            // Received machine mode preamble length
+    bool is_machine_mode;                               // Binary framed mode (line editor is bypassed)
+    bool is_frame_request;                              // Running command is started from request frame
+    bool is_frame_rx_overflow;                          // Incoming frame is too long - skip it until delimiter
+    uint8_t frame_rx[CLI_FRAME_MAX_SIZE];               // Incoming frame buffer
+    int32_t frame_rx_length;                            // Incoming frame length
+    uint8_t frame_tx[CLI_FRAME_MAX_SIZE];               // Response frame buffer for running command
+    int32_t frame_tx_length;                            // Response frame length
+
+    uint8_t request_queue_id[CLI_FRAME_QUEUE_SIZE];     // Pipelined requests IDs
+    cli_cmd_info_t request_queue[CLI_FRAME_QUEUE_SIZE]; // Pipelined requests commands
+    int32_t request_queue_head;                         // Request queue first item index
+    int32_t request_queue_length;                       // Request queue items count
+
+    cli_stats_t stats;                                  // Session statistics
+};
+
+
+extern bool cli_core_register_commands(const cli_cmd_t* cmd_list, int32_t cmd_count);
+extern uint32_t cli_core_get_trie_memory_usage(void);
+
+extern void cli_core_init(cli_session_t* session, void(*send_data)(void* context, const char* data), void* context);
+extern void cli_core_reset(cli_session_t* session);
+extern void cli_core_set_tx_ready_callback(cli_session_t* session, bool(*is_tx_ready)(void* context));
+extern void cli_core_set_frame_callback(cli_session_t* session, void(*send_frame)(void* context, const uint8_t* data, uint32_t size));
+extern bool cli_core_set_machine_mode(cli_session_t* session, bool is_enable);
+extern void cli_core_symbol_received(cli_session_t* session, char symbol);
+extern void cli_core_process(cli_session_t* session);
+extern void cli_core_send(cli_session_t* session, const char* data);
+extern char* cli_core_format_hex(char* str, uint32_t value, int32_t digits);
+extern char* cli_core_format_dec(char* str, uint32_t value);
+extern void cli_core_get_stats(const cli_session_t* session, cli_stats_t* stats);
+extern void cli_core_reset_stats(cli_session_t* session);
+
+
+#endif // _CLI_CORE_H_
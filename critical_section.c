@@ -0,0 +1,55 @@
+//  ***************************************************************************
+/// @file    critical_section.c
+/// @author  NeoProg
+/// @brief   Critical section for host builds (Cortex-M version is inline)
+//  ***************************************************************************
+#define _GNU_SOURCE
+#include "critical_section.h"
+#include <stdint.h>
+#if !(defined(__ARM_ARCH_PROFILE) && (__ARM_ARCH_PROFILE == 'M'))
+#include <pthread.h>
+
+
+static pthread_mutex_t lock;
+static pthread_once_t lock_once = PTHREAD_ONCE_INIT;
+
+
+static void lock_init(void);
+
+
+//  ***************************************************************************
+/// @brief  Enter critical section (take global recursive lock)
+/// @return state for critical_section_exit() (not used)
+//  ***************************************************************************
+uint32_t critical_section_enter(void) {
+    pthread_once(&lock_once, lock_init);
+    pthread_mutex_lock(&lock);
+    return 0;
+}
+
+//  ***************************************************************************
+/// @brief  Exit critical section (release global recursive lock)
+/// @param  state: value returned by critical_section_enter()
+/// @return none
+//  ***************************************************************************
+void critical_section_exit(uint32_t state) {
+    (void)state;
+    pthread_mutex_unlock(&lock);
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Create recursive lock: sections can be nested as on Cortex-M
+//  ***************************************************************************
+static void lock_init(void) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+#endif
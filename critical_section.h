@@ -0,0 +1,49 @@
+//  ***************************************************************************
+/// @file    critical_section.h
+/// @author  NeoProg
+/// @brief   Critical section for data shared between ISR and main loop
+/// @note    Cortex-M: IRQs are masked (PRIMASK), nested sections are allowed.
+///          Host: one global recursive lock (ISR is modelled by thread)
+//  ***************************************************************************
+#ifndef _CRITICAL_SECTION_H_
+#define _CRITICAL_SECTION_H_
+#include <stdint.h>
+
+// Define CRITICAL_SECTION_ENTER/CRITICAL_SECTION_EXIT in project for use RTOS critical section
+// Usage: uint32_t state = CRITICAL_SECTION_ENTER(); ... CRITICAL_SECTION_EXIT(state);
+#ifndef CRITICAL_SECTION_ENTER
+#define CRITICAL_SECTION_ENTER()            critical_section_enter()
+#define CRITICAL_SECTION_EXIT(state)        critical_section_exit(state)
+#endif
+
+
+#if defined(__ARM_ARCH_PROFILE) && (__ARM_ARCH_PROFILE == 'M')
+
+//  ***************************************************************************
+/// @brief  Enter critical section (mask IRQs)
+/// @return previous PRIMASK value
+//  ***************************************************************************
+static inline uint32_t critical_section_enter(void) {
+    uint32_t primask;
+    __asm volatile ("mrs %0, primask\n\tcpsid i" : "=r" (primask) :: "memory");
+    return primask;
+}
+
+//  ***************************************************************************
+/// @brief  Exit critical section (restore PRIMASK)
+/// @param  state: value returned by critical_section_enter()
+/// @return none
+//  ***************************************************************************
+static inline void critical_section_exit(uint32_t state) {
+    __asm volatile ("msr primask, %0" :: "r" (state) : "memory");
+}
+
+#else
+
+extern uint32_t critical_section_enter(void);
+extern void critical_section_exit(uint32_t state);
+
+#endif
+
+
+#endif // _CRITICAL_SECTION_H_
@@ -0,0 +1,78 @@
+//  ***************************************************************************
+/// @file    fuzz_cli.c
+/// @author  NeoProg
+/// @brief   Fuzz target: CLI session input (line editor, escape sequences,
+///          machine mode frames) with VEEPROM and trace commands
+/// @note    Input is symbols stream. Main loop model: cli_core_process() is
+///          called once per symbol, running command is finished after input
+//  ***************************************************************************
+#include "cli_core.h"
+#include "trace_cli.h"
+#include "veeprom_cli.h"
+#include "veeprom_fixture.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define FLASH_PAGE_SIZE                     (1024)
+#define MAX_PROCESS_CALLS                   (100000)    // Running command should finish in this calls count
+
+
+static void send_data(void* context, const char* data);
+static void send_frame(void* context, const uint8_t* data, uint32_t size);
+
+
+static const cli_cmd_t cmd_list[] = {
+    VEEPROM_CLI_CMD,
+    TRACE_CLI_CMD
+};
+static cli_session_t session;
+static veeprom_t veeprom;
+static bool is_initialized = false;
+
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (!is_initialized) {
+        cli_core_register_commands(cmd_list, sizeof(cmd_list) / sizeof(cmd_list[0]));
+        veeprom_cli_attach(&veeprom);
+        is_initialized = true;
+    }
+
+    // Erased FLASH for each input: result does not depend on previous inputs
+    veeprom_config_t config;
+    veeprom_fixture_init(&veeprom, &config, FLASH_PAGE_SIZE, 1, 2, NULL);
+
+    cli_core_init(&session, send_data, NULL);
+    cli_core_set_frame_callback(&session, send_frame);
+    for (size_t i = 0; i < size; ++i) {
+        cli_core_symbol_received(&session, (char)data[i]);
+        cli_core_process(&session);
+    }
+    for (uint32_t i = 0; session.running_cmd != NULL; ++i) {
+        if (i >= MAX_PROCESS_CALLS) {
+            abort(); // Command is not finished
+        }
+        cli_core_process(&session);
+    }
+
+    veeprom_flash_sim_deinit();
+    return 0;
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Output callbacks: output is dropped
+//  ***************************************************************************
+static void send_data(void* context, const char* data) {
+    (void)context;
+    (void)data;
+}
+static void send_frame(void* context, const uint8_t* data, uint32_t size) {
+    (void)context;
+    (void)data;
+    (void)size;
+}
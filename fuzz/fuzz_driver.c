@@ -0,0 +1,265 @@
+//  ***************************************************************************
+/// @file    fuzz_driver.c
+/// @author  NeoProg
+/// @brief   Standalone fuzz driver for toolchains without libFuzzer: runs
+///          corpus and random mutations of corpus through fuzz target and
+///          reports executions per second
+/// @note    Usage: fuzz_<target> [-runs=N] [-seed=N] [output.json] corpus...
+///          Corpus item can be file or directory. Mutations are not coverage
+///          guided - use libFuzzer build (FUZZ_LIBFUZZER) for long campaigns
+//  ***************************************************************************
+#define _GNU_SOURCE
+#include "bench.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+
+#ifndef FUZZ_TARGET_NAME
+#define FUZZ_TARGET_NAME                    "target"
+#endif
+#define DEFAULT_RUNS                        (100000)
+#define MAX_INPUT_SIZE                      (4096)
+#define MAX_CORPUS_SIZE                     (1024)
+#define CRASH_FILE_NAME                     "crash-" FUZZ_TARGET_NAME
+
+
+typedef struct {
+    uint8_t* data;
+    uint32_t size;
+} input_t;
+
+
+extern int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+extern void __sanitizer_set_death_callback(void(*callback)(void)) __attribute__((weak));
+
+static void corpus_load(const char* path);
+static void corpus_add_file(const char* path);
+static uint32_t mutate(uint8_t* data, uint32_t size);
+static uint32_t random_next(void);
+static void run_input(const uint8_t* data, uint32_t size);
+static void crash_handler(int signal_number);
+static void save_crash_input(void);
+
+
+static const uint8_t interesting_symbols[] = { 0x00, 0x03, 0x08, 0x09, 0x0A, 0x0D, 0x12, 0x1B, 0x5B, 0x7E, 0x7F, 0xC0, 0xC1, 0xFF };
+static input_t corpus[MAX_CORPUS_SIZE];
+static uint32_t corpus_size = 0;
+static uint32_t random_state = 1;
+static const uint8_t* volatile current_data = NULL;    // Running input (saved to CRASH_FILE_NAME on crash)
+static volatile uint32_t current_size = 0;
+
+
+int main(int argc, char* argv[]) {
+    const char* output_path = NULL;
+    uint32_t runs = DEFAULT_RUNS;
+    for (int i = 1; i < argc; ++i) {
+        if (strncmp(argv[i], "-runs=", 6) == 0) {
+            runs = strtoul(&argv[i][6], NULL, 0);
+        }
+        else if (strncmp(argv[i], "-seed=", 6) == 0) {
+            random_state = strtoul(&argv[i][6], NULL, 0) | 1;
+        }
+        else if (strstr(argv[i], ".json") != NULL) {
+            output_path = argv[i];
+        }
+        else {
+            corpus_load(argv[i]);
+        }
+    }
+    signal(SIGABRT, crash_handler);
+    signal(SIGSEGV, crash_handler);
+    if (__sanitizer_set_death_callback != NULL) {
+        __sanitizer_set_death_callback(save_crash_input);
+    }
+    if (corpus_size == 0) {
+        corpus[corpus_size++] = (input_t){ .data = malloc(MAX_INPUT_SIZE), .size = 0 }; // Start from empty input
+    }
+
+    // Corpus as is
+    uint64_t begin = bench_get_time_ns();
+    for (uint32_t i = 0; i < corpus_size; ++i) {
+        run_input(corpus[i].data, corpus[i].size);
+    }
+
+    // Mutations
+    uint8_t buffer[MAX_INPUT_SIZE];
+    for (uint32_t i = 0; i < runs; ++i) {
+        const input_t* input = &corpus[random_next() % corpus_size];
+        memcpy(buffer, input->data, input->size);
+        uint32_t size = input->size;
+        for (uint32_t m = 1 + random_next() % 4; m > 0; --m) {
+            size = mutate(buffer, size);
+        }
+        run_input(buffer, size);
+    }
+    uint64_t elapsed = bench_get_time_ns() - begin;
+
+    bench_report("fuzz." FUZZ_TARGET_NAME ".execs_per_sec", (corpus_size + runs) * 1e9 / elapsed, "execs/s", false);
+    return bench_save_report(output_path) ? 0 : 1;
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Load corpus file or directory
+/// @param  path: file or directory path
+/// @return none
+//  ***************************************************************************
+static void corpus_load(const char* path) {
+    DIR* dir = opendir(path);
+    if (dir == NULL) {
+        corpus_add_file(path);
+        return;
+    }
+    struct dirent* entry;
+    char file_path[1024];
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] != '.') {
+            snprintf(file_path, sizeof(file_path), "%s/%s", path, entry->d_name);
+            corpus_add_file(file_path);
+        }
+    }
+    closedir(dir);
+}
+
+//  ***************************************************************************
+/// @brief  Add file to corpus (inputs over MAX_INPUT_SIZE are truncated)
+/// @param  path: file path
+/// @return none
+//  ***************************************************************************
+static void corpus_add_file(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL || corpus_size >= MAX_CORPUS_SIZE) {
+        if (file != NULL) {
+            fclose(file);
+        }
+        return;
+    }
+    input_t* input = &corpus[corpus_size++];
+    input->data = malloc(MAX_INPUT_SIZE);
+    input->size = fread(input->data, 1, MAX_INPUT_SIZE, file);
+    fclose(file);
+}
+
+//  ***************************************************************************
+/// @brief  Apply one random mutation
+/// @param  data: input buffer (MAX_INPUT_SIZE bytes)
+/// @param  size: input size
+/// @return new input size
+//  ***************************************************************************
+static uint32_t mutate(uint8_t* data, uint32_t size) {
+    uint32_t pos = size ? random_next() % size : 0;
+    switch (random_next() % 6) {
+        case 0: // Flip bit
+            if (size > 0) {
+                data[pos] ^= (uint8_t)(1 << (random_next() % 8));
+            }
+            break;
+        case 1: // Replace by random byte
+            if (size > 0) {
+                data[pos] = (uint8_t)random_next();
+            }
+            break;
+        case 2: // Insert interesting symbol
+            if (size < MAX_INPUT_SIZE) {
+                memmove(&data[pos + 1], &data[pos], size - pos);
+                data[pos] = interesting_symbols[random_next() % sizeof(interesting_symbols)];
+                ++size;
+            }
+            break;
+        case 3: // Delete range
+            if (size > 0) {
+                uint32_t count = 1 + random_next() % (size - pos);
+                memmove(&data[pos], &data[pos + count], size - pos - count);
+                size -= count;
+            }
+            break;
+        case 4: // Duplicate range
+            if (size > 0) {
+                uint32_t count = 1 + random_next() % (size - pos);
+                if (size + count <= MAX_INPUT_SIZE) {
+                    memmove(&data[pos + count], &data[pos], size - pos);
+                    size += count;
+                }
+            }
+            break;
+        case 5: { // Splice with other corpus input
+            const input_t* other = &corpus[random_next() % corpus_size];
+            uint32_t other_pos = other->size ? random_next() % other->size : 0;
+            uint32_t count = other->size - other_pos;
+            if (pos + count > MAX_INPUT_SIZE) {
+                count = MAX_INPUT_SIZE - pos;
+            }
+            memcpy(&data[pos], &other->data[other_pos], count);
+            size = pos + count;
+            break;
+        }
+    }
+    return size;
+}
+
+//  ***************************************************************************
+/// @brief  Pseudo-random generator (xorshift32)
+/// @return random value
+//  ***************************************************************************
+static uint32_t random_next(void) {
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+//  ***************************************************************************
+/// @brief  Run fuzz target with exact size copy of input (sanitizers detect overread)
+/// @param  data: input data
+/// @param  size: input size
+/// @return none
+//  ***************************************************************************
+static void run_input(const uint8_t* data, uint32_t size) {
+    uint8_t* copy = malloc(size ? size : 1);
+    if (size > 0) {
+        memcpy(copy, data, size);
+    }
+    current_data = copy;
+    current_size = size;
+    LLVMFuzzerTestOneInput(copy, size);
+    current_data = NULL;
+    free(copy);
+}
+
+//  ***************************************************************************
+/// @brief  Fatal signal handler: save running input and terminate
+/// @param  signal_number: signal number
+//  ***************************************************************************
+static void crash_handler(int signal_number) {
+    save_crash_input();
+    signal(signal_number, SIG_DFL);
+    raise(signal_number);
+}
+
+//  ***************************************************************************
+/// @brief  Save running input to CRASH_FILE_NAME (async-signal-safe)
+//  ***************************************************************************
+static void save_crash_input(void) {
+    if (current_data == NULL) {
+        return;
+    }
+    int fd = open(CRASH_FILE_NAME, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) {
+        ssize_t result = write(fd, (const void*)current_data, current_size);
+        (void)result;
+        close(fd);
+    }
+    static const char message[] = "fuzz: crash input is saved to " CRASH_FILE_NAME "\n";
+    ssize_t result = write(STDERR_FILENO, message, sizeof(message) - 1);
+    (void)result;
+}
@@ -0,0 +1,165 @@
+//  ***************************************************************************
+/// @file    fuzz_ring_buffer.c
+/// @author  NeoProg
+/// @brief   Fuzz target: ring buffer API against reference model (items,
+///          count and notification callbacks)
+/// @note    Input is operations stream: [op] or [op][arg]
+//  ***************************************************************************
+#include "ring_buffer.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#define CHECK(condition)                    do { if (!(condition)) abort(); } while (0)
+
+
+typedef enum {
+    OP_PUSH,                                            // arg: data
+    OP_POP,
+    OP_CLEAR,
+    OP_SET_CALLBACKS,                                   // arg: [high level: 4 bits][low level: 4 bits]
+    OP_RESET_CALLBACKS,
+    OP_BAD_ID,
+    OPS_COUNT
+} op_t;
+
+typedef struct {
+    uint8_t items[RING_BUFFER_SIZE];
+    uint32_t head;
+    uint32_t count;
+    bool is_high;
+    ring_buffer_callbacks_t callbacks;
+    uint32_t expected_calls[3];                         // Expected data_available, high_watermark, low_watermark calls
+} model_t;
+
+
+static void model_push(model_t* model, uint8_t data);
+static bool model_pop(model_t* model, uint8_t* data);
+static void data_available_callback(ring_buffer_id buffer_id, void* context);
+static void high_watermark_callback(ring_buffer_id buffer_id, void* context);
+static void low_watermark_callback(ring_buffer_id buffer_id, void* context);
+
+
+static uint32_t calls[3];
+
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    model_t model;
+    memset(&model, 0, sizeof(model));
+    memset(calls, 0, sizeof(calls));
+    ring_buffer_set_callbacks(RING_BUFFER_1, NULL);
+    ring_buffer_init(RING_BUFFER_1);
+
+    for (size_t i = 0; i < size; ++i) {
+        uint8_t arg = (i + 1 < size) ? data[i + 1] : 0;
+        uint8_t item = 0;
+        uint8_t expected = 0;
+        switch (data[i] % OPS_COUNT) {
+            case OP_PUSH:
+                ring_buffer_push(RING_BUFFER_1, arg);
+                model_push(&model, arg);
+                ++i;
+                break;
+            case OP_POP:
+                CHECK(ring_buffer_pop(RING_BUFFER_1, &item) == model_pop(&model, &expected));
+                CHECK(item == expected);
+                break;
+            case OP_CLEAR:
+                ring_buffer_clear(RING_BUFFER_1);
+                model.count = 0;
+                model.is_high = false;
+                break;
+            case OP_SET_CALLBACKS:
+                model.callbacks.data_available = data_available_callback;
+                model.callbacks.high_watermark = high_watermark_callback;
+                model.callbacks.low_watermark = low_watermark_callback;
+                model.callbacks.high_level = (arg >> 4) % (RING_BUFFER_SIZE + 1);
+                model.callbacks.low_level = (arg & 0x0F) % (RING_BUFFER_SIZE + 1);
+                model.callbacks.context = &model;
+                ring_buffer_set_callbacks(RING_BUFFER_1, &model.callbacks);
+                model.is_high = model.callbacks.high_level != 0 && model.count >= model.callbacks.high_level;
+                ++i;
+                break;
+            case OP_RESET_CALLBACKS:
+                memset(&model.callbacks, 0, sizeof(model.callbacks));
+                ring_buffer_set_callbacks(RING_BUFFER_1, NULL);
+                model.is_high = false;
+                break;
+            case OP_BAD_ID:
+                ring_buffer_push(RING_BUFFERS_COUNT, arg);
+                CHECK(!ring_buffer_pop(RING_BUFFERS_COUNT, &item));
+                CHECK(ring_buffer_is_empty(RING_BUFFERS_COUNT));
+                CHECK(ring_buffer_get_count(RING_BUFFERS_COUNT) == 0);
+                break;
+        }
+        CHECK(ring_buffer_get_count(RING_BUFFER_1) == model.count);
+        CHECK(ring_buffer_is_empty(RING_BUFFER_1) == (model.count == 0));
+        CHECK(memcmp(calls, model.expected_calls, sizeof(calls)) == 0);
+    }
+
+    ring_buffer_set_callbacks(RING_BUFFER_1, NULL);
+    return 0;
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Reference model: push with overwrite of oldest item
+//  ***************************************************************************
+static void model_push(model_t* model, uint8_t data) {
+    if (model->count == RING_BUFFER_SIZE) {
+        model->items[model->head] = data;
+        model->head = (model->head + 1) % RING_BUFFER_SIZE;
+        return;
+    }
+    model->items[(model->head + model->count) % RING_BUFFER_SIZE] = data;
+    ++model->count;
+    if (model->count == 1 && model->callbacks.data_available != NULL) {
+        ++model->expected_calls[0];
+    }
+    if (model->callbacks.high_level != 0 && model->count == model->callbacks.high_level && !model->is_high) {
+        model->is_high = true;
+        if (model->callbacks.high_watermark != NULL) {
+            ++model->expected_calls[1];
+        }
+    }
+}
+
+//  ***************************************************************************
+/// @brief  Reference model: pop
+//  ***************************************************************************
+static bool model_pop(model_t* model, uint8_t* data) {
+    if (model->count == 0) {
+        return false;
+    }
+    *data = model->items[model->head];
+    model->head = (model->head + 1) % RING_BUFFER_SIZE;
+    --model->count;
+    if (model->is_high && model->count <= model->callbacks.low_level) {
+        model->is_high = false;
+        if (model->callbacks.low_watermark != NULL) {
+            ++model->expected_calls[2];
+        }
+    }
+    return true;
+}
+
+//  ***************************************************************************
+/// @brief  Notification callbacks: count calls and check context
+//  ***************************************************************************
+static void data_available_callback(ring_buffer_id buffer_id, void* context) {
+    CHECK(buffer_id == RING_BUFFER_1 && context != NULL);
+    ++calls[0];
+}
+static void high_watermark_callback(ring_buffer_id buffer_id, void* context) {
+    CHECK(buffer_id == RING_BUFFER_1 && context != NULL);
+    ++calls[1];
+}
+static void low_watermark_callback(ring_buffer_id buffer_id, void* context) {
+    CHECK(buffer_id == RING_BUFFER_1 && context != NULL);
+    ++calls[2];
+}
@@ -0,0 +1,40 @@
+//  ***************************************************************************
+/// @file    veeprom_fixture.c
+/// @author  NeoProg
+/// @brief   VEEPROM instance on simulated FLASH (tests, benchmarks and fuzz targets)
+//  ***************************************************************************
+#include "veeprom_fixture.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+
+//  ***************************************************************************
+/// @brief  Create erased simulated FLASH and init VEEPROM instance on it
+/// @param  [out] veeprom: instance context
+/// @param  [out] config: instance configuration (for init instance again)
+/// @param  [in] page_size: FLASH page size
+/// @param  [in] page_count: FLASH pages count in VEEPROM page
+/// @param  [in] program_width: FLASH program unit size
+/// @param  [in] cache: write-back RAM image, NULL - write-through
+/// @return true - success, false - fail
+//  ***************************************************************************
+bool veeprom_fixture_init(veeprom_t* veeprom, veeprom_config_t* config, uint32_t page_size,
+                          uint32_t page_count, uint32_t program_width, uint8_t* cache) {
+    uint32_t veeprom_page_size = page_size * page_count;
+    if (!veeprom_flash_sim_init(VEEPROM_FIXTURE_BASE_ADDR, veeprom_page_size * VEEPROM_PAGES_COUNT, page_size)) {
+        return false;
+    }
+    veeprom_flash_sim_set_strict(true);
+
+    memset(config, 0, sizeof(veeprom_config_t));
+    for (uint32_t i = 0; i < VEEPROM_PAGES_COUNT; ++i) {
+        config->page_addr[i] = VEEPROM_FIXTURE_BASE_ADDR + i * veeprom_page_size;
+    }
+    config->page_size = page_size;
+    config->page_count = page_count;
+    config->program_width = program_width;
+    config->cache = cache;
+    config->flush_interval_us = 0;
+    return veeprom_init(veeprom, config);
+}
@@ -0,0 +1,33 @@
+//  ***************************************************************************
+/// @file    veeprom_fixture.h
+/// @author  NeoProg
+/// @brief   VEEPROM instance on simulated FLASH (tests, benchmarks and fuzz targets)
+//  ***************************************************************************
+#ifndef _VEEPROM_FIXTURE_H_
+#define _VEEPROM_FIXTURE_H_
+#include "veeprom.h"
+#include "veeprom_flash_sim.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#define VEEPROM_FIXTURE_BASE_ADDR           (0x08003800)
+
+
+//  ***************************************************************************
+/// @brief  Create erased simulated FLASH (ECC behavior) for two VEEPROM pages
+///         and init VEEPROM instance on it
+/// @note   Pages are placed one after another from VEEPROM_FIXTURE_BASE_ADDR,
+///         flush interval is 0. Release FLASH by veeprom_flash_sim_deinit()
+/// @param  [out] veeprom: instance context
+/// @param  [out] config: instance configuration (for init instance again)
+/// @param  [in] page_size: FLASH page size
+/// @param  [in] page_count: FLASH pages count in VEEPROM page
+/// @param  [in] program_width: FLASH program unit size
+/// @param  [in] cache: write-back RAM image, NULL - write-through
+/// @return true - success, false - fail
+//  ***************************************************************************
+extern bool veeprom_fixture_init(veeprom_t* veeprom, veeprom_config_t* config, uint32_t page_size,
+                                 uint32_t page_count, uint32_t program_width, uint8_t* cache);
+
+
+#endif // _VEEPROM_FIXTURE_H_
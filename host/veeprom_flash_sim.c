@@ -0,0 +1,205 @@
+//  ***************************************************************************
+/// @file    veeprom_flash_sim.c
+/// @author  NeoProg
+/// @brief   VEEPROM FLASH port for host: FLASH is simulated in RAM
+//  ***************************************************************************
+#include "veeprom_flash_sim.h"
+#include "veeprom_flash.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+
+static uint8_t* memory = NULL;
+static uint32_t memory_base_addr = 0;
+static uint32_t memory_size = 0;
+static uint32_t memory_page_size = 0;
+static bool is_locked = true;
+static bool is_strict = false;
+static veeprom_flash_sim_stat_t stat = {0};
+static veeprom_flash_sim_hook_t program_hook = NULL;
+static void* program_hook_context = NULL;
+
+
+static uint8_t* sim_get_cell(uint32_t flash_addr, uint32_t size);
+
+
+//  ***************************************************************************
+/// @brief  Create simulated FLASH region (erased, locked)
+/// @param  base_addr: region address
+/// @param  size: region size (multiple of page size)
+/// @param  page_size: erase page size
+/// @return true - success, false - fail
+//  ***************************************************************************
+bool veeprom_flash_sim_init(uint32_t base_addr, uint32_t size, uint32_t page_size) {
+    veeprom_flash_sim_deinit();
+    if (page_size == 0 || size % page_size != 0) {
+        return false;
+    }
+    memory = malloc(size);
+    if (memory == NULL) {
+        return false;
+    }
+    memset(memory, 0xFF, size);
+    memory_base_addr = base_addr;
+    memory_size = size;
+    memory_page_size = page_size;
+    is_locked = true;
+    veeprom_flash_sim_reset_stat();
+    return true;
+}
+void veeprom_flash_sim_deinit(void) {
+    free(memory);
+    memory = NULL;
+    memory_size = 0;
+    program_hook = NULL;
+}
+
+//  ***************************************************************************
+/// @brief  Enable ECC FLASH behavior
+/// @param  strict: true - ECC FLASH, false - NOR FLASH
+/// @return none
+//  ***************************************************************************
+void veeprom_flash_sim_set_strict(bool strict) {
+    is_strict = strict;
+}
+
+//  ***************************************************************************
+/// @brief  Set program hook
+/// @param  hook: hook, NULL - disable hook
+/// @param  context: user context for hook
+/// @return none
+//  ***************************************************************************
+void veeprom_flash_sim_set_program_hook(veeprom_flash_sim_hook_t hook, void* context) {
+    program_hook = hook;
+    program_hook_context = context;
+}
+
+//  ***************************************************************************
+/// @brief  Get simulated FLASH memory
+/// @return pointer to memory of region
+//  ***************************************************************************
+uint8_t* veeprom_flash_sim_get_memory(void) {
+    return memory;
+}
+
+//  ***************************************************************************
+/// @brief  Get/reset simulated FLASH statistics
+/// @param  buffer: buffer for statistics
+/// @return none
+//  ***************************************************************************
+void veeprom_flash_sim_get_stat(veeprom_flash_sim_stat_t* buffer) {
+    *buffer = stat;
+}
+void veeprom_flash_sim_reset_stat(void) {
+    memset(&stat, 0, sizeof(stat));
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Lock/unlock FLASH
+/// @return true - success, false - fail
+//  ***************************************************************************
+bool veeprom_flash_lock() {
+    is_locked = true;
+    return true;
+}
+bool veeprom_flash_unlock() {
+    is_locked = false;
+    return true;
+}
+
+//  ***************************************************************************
+/// @brief  Erase FLASH page
+/// @param  [in] flash_addr: page address for erase
+/// @return true - success, false - fail
+//  ***************************************************************************
+bool veeprom_flash_page_erase(uint32_t flash_addr) {
+    uint8_t* cell = sim_get_cell(flash_addr, memory_page_size);
+    if (cell == NULL || (flash_addr - memory_base_addr) % memory_page_size != 0) {
+        ++stat.error_count;
+        return false;
+    }
+    ++stat.erase_count;
+    memset(cell, 0xFF, memory_page_size);
+    return true;
+}
+
+//  ***************************************************************************
+/// @brief  Read data from FLASH in BE format
+/// @param  [in] flash_addr: cell address
+/// @return cell value
+//  ***************************************************************************
+uint8_t veeprom_flash_read_8(uint32_t flash_addr) {
+    uint8_t* cell = sim_get_cell(flash_addr, 1);
+    return cell ? cell[0] : 0xFF;
+}
+uint16_t veeprom_flash_read_16(uint32_t flash_addr) {
+    return (uint16_t)((veeprom_flash_read_8(flash_addr) << 8) | veeprom_flash_read_8(flash_addr + 1));
+}
+uint32_t veeprom_flash_read_32(uint32_t flash_addr) {
+    return ((uint32_t)veeprom_flash_read_16(flash_addr) << 16) | veeprom_flash_read_16(flash_addr + 2);
+}
+
+//  ***************************************************************************
+/// @brief  Check FLASH program unit size (simulated FLASH programs any unit natively)
+/// @param  [in] width: unit size
+/// @return true - unit is programmed natively, false - not supported
+//  ***************************************************************************
+bool veeprom_flash_is_width_supported(uint32_t width) {
+    return width == 2 || width == 4 || width == 8;
+}
+
+//  ***************************************************************************
+/// @brief  Program one FLASH unit (FLASH should be unlocked)
+/// @param  [in] flash_addr: unit address (aligned to width)
+/// @param  [in] data: unit data
+/// @param  [in] width: unit size - 2, 4 or 8 bytes
+/// @return true - success, false - fail
+//  ***************************************************************************
+bool veeprom_flash_program(uint32_t flash_addr, const uint8_t* data, uint32_t width) {
+    uint8_t* cell = sim_get_cell(flash_addr, width);
+    if (cell == NULL || is_locked || (width != 2 && width != 4 && width != 8) || flash_addr % width != 0) {
+        ++stat.error_count;
+        return false;
+    }
+    ++stat.program_count;
+    stat.program_bytes += width;
+
+    for (uint32_t i = 0; i < width && is_strict; ++i) {
+        if (cell[i] != 0xFF) {
+            ++stat.error_count; // ECC FLASH: unit can be programmed once after erase
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < width; ++i) {
+        cell[i] &= data[i]; // Program can clear bits only
+    }
+    bool result = memcmp(cell, data, width) == 0;
+    if (program_hook != NULL) {
+        program_hook(stat.program_count, program_hook_context);
+    }
+    return result;
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Get pointer to simulated FLASH cells
+/// @param  flash_addr: cells address
+/// @param  size: cells count
+/// @return pointer to cells, NULL - address is out of region
+//  ***************************************************************************
+static uint8_t* sim_get_cell(uint32_t flash_addr, uint32_t size) {
+    if (memory == NULL || flash_addr < memory_base_addr || flash_addr - memory_base_addr > memory_size ||
+        size > memory_size - (flash_addr - memory_base_addr)) {
+        return NULL;
+    }
+    return &memory[flash_addr - memory_base_addr];
+}
@@ -0,0 +1,58 @@
+//  ***************************************************************************
+/// @file    veeprom_flash_sim.h
+/// @author  NeoProg
+/// @brief   Simulated FLASH for VEEPROM port on host (tests and benchmarks)
+//  ***************************************************************************
+#ifndef _VEEPROM_FLASH_SIM_H_
+#define _VEEPROM_FLASH_SIM_H_
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+    uint32_t erase_count;                               // Erased pages count
+    uint32_t program_count;                             // Program operations count
+    uint32_t program_bytes;                             // Programmed bytes count
+    uint32_t error_count;                               // Bad address, locked FLASH or reprogram errors
+} veeprom_flash_sim_stat_t;
+
+// Program hook: called after each program operation (e.g. for call power fail handler in middle of page swap)
+typedef void(*veeprom_flash_sim_hook_t)(uint32_t program_count, void* context);
+
+
+//  ***************************************************************************
+/// @brief  Create simulated FLASH region (erased, locked)
+/// @param  base_addr: region address
+/// @param  size: region size (multiple of page size)
+/// @param  page_size: erase page size
+/// @return true - success, false - fail
+//  ***************************************************************************
+extern bool veeprom_flash_sim_init(uint32_t base_addr, uint32_t size, uint32_t page_size);
+extern void veeprom_flash_sim_deinit(void);
+
+//  ***************************************************************************
+/// @brief  Enable ECC FLASH behavior: program of not erased bytes is error.
+///         Otherwise program clears bits only (NOR FLASH behavior)
+/// @param  strict: true - ECC FLASH, false - NOR FLASH
+/// @return none
+//  ***************************************************************************
+extern void veeprom_flash_sim_set_strict(bool strict);
+
+//  ***************************************************************************
+/// @brief  Set program hook
+/// @param  hook: hook, NULL - disable hook
+/// @param  context: user context for hook
+/// @return none
+//  ***************************************************************************
+extern void veeprom_flash_sim_set_program_hook(veeprom_flash_sim_hook_t hook, void* context);
+
+//  ***************************************************************************
+/// @brief  Get simulated FLASH memory (for inspect or corrupt content)
+/// @return pointer to memory of region
+//  ***************************************************************************
+extern uint8_t* veeprom_flash_sim_get_memory(void);
+
+extern void veeprom_flash_sim_get_stat(veeprom_flash_sim_stat_t* buffer);
+extern void veeprom_flash_sim_reset_stat(void);
+
+
+#endif // _VEEPROM_FLASH_SIM_H_
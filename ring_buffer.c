@@ -3,9 +3,24 @@
 /// @author  NeoProg
 //  ***************************************************************************
 #include "ring_buffer.h"
+#include "trace.h"
+#include "critical_section.h"
 #include <stdlib.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
+
+// Buffer lock: Cortex-M - IRQs are masked (push is called from RX ISR).
+// Host - own lock for each buffer (ISR is modelled by thread)
+#if defined(__ARM_ARCH_PROFILE) && (__ARM_ARCH_PROFILE == 'M')
+#define BUFFER_LOCK(buffer)                 CRITICAL_SECTION_ENTER()
+#define BUFFER_UNLOCK(buffer, state)        CRITICAL_SECTION_EXIT(state)
+#else
+#include <sched.h>
+#define BUFFER_HOST_LOCK
+#define BUFFER_LOCK(buffer)                 buffer_lock(buffer)
+#define BUFFER_UNLOCK(buffer, state)        buffer_unlock(buffer, state)
+#endif
 
 typedef struct {
 	uint8_t data;   // Node data
@@ -16,21 +31,50 @@ typedef struct {
 	node_t   nodes[RING_BUFFER_SIZE];   // Node list
 	node_t*  head;						// Pointer to head of buffer
 	node_t*  tail;						// Pointer to tail of buffer
+	uint32_t count;						// Items count
+	bool     is_high;					// High watermark is reached (low watermark is armed)
+	ring_buffer_callbacks_t callbacks;	// Notification callbacks
+#ifdef BUFFER_HOST_LOCK
+	bool     lock;						// Buffer is locked by thread
+#endif
 } ring_buffer_t;
 
 
 static ring_buffer_t ring_buffer[RING_BUFFERS_COUNT] = {0};
 
 
+#ifdef BUFFER_HOST_LOCK
+//  ***************************************************************************
+/// @brief  Lock/unlock buffer (host)
+/// @param  buffer: ring buffer
+/// @param  state: value returned by buffer_lock() (not used)
+//  ***************************************************************************
+static inline uint32_t buffer_lock(ring_buffer_t* buffer) {
+	while (__atomic_test_and_set(&buffer->lock, __ATOMIC_ACQUIRE)) {
+		sched_yield(); // Lock owner can be preempted by waiting thread
+	}
+	return 0;
+}
+static inline void buffer_unlock(ring_buffer_t* buffer, uint32_t state) {
+	(void)state;
+	__atomic_clear(&buffer->lock, __ATOMIC_RELEASE);
+}
+#endif
+
+
 //  ***************************************************************************
 /// @brief  Ring buffer initialization
 /// @param  buffer_id: ring buffer id
 /// @return none
 //  ***************************************************************************
 void ring_buffer_init(ring_buffer_id buffer_id) {
+	if (buffer_id >= RING_BUFFERS_COUNT) {
+		return;
+	}
 	ring_buffer_t* buffer = &ring_buffer[buffer_id];
 
 	// Make nodes loop: [0]->[1]->[...]->[N]->[0]
+	uint32_t state = BUFFER_LOCK(buffer);
 	for (uint32_t i = 0; i < RING_BUFFER_SIZE - 1; ++i) {
 		buffer->nodes[i].data = 0;
 		buffer->nodes[i].next = &buffer->nodes[i + 1];
@@ -38,23 +82,36 @@ void ring_buffer_init(ring_buffer_id buffer_id) {
 	buffer->nodes[RING_BUFFER_SIZE - 1].data = 0;
 	buffer->nodes[RING_BUFFER_SIZE - 1].next = &buffer->nodes[0];
 
-	// Initialization head and tail
+	// Initialization head and tail. Callbacks are kept
 	buffer->head = NULL;
 	buffer->tail = NULL;
+	buffer->count = 0;
+	buffer->is_high = false;
+	BUFFER_UNLOCK(buffer, state);
 }
 
 //  ***************************************************************************
 /// @brief  Push data to ring buffer
 /// @param  buffer_id: ring buffer id
 /// @param  data: data for enqueue
+/// @note   Buffer is updated and notifications are decided under buffer lock
+///         (push from ISR and pop from main loop), callbacks are called after it
 //  ***************************************************************************
 void ring_buffer_push(ring_buffer_id buffer_id, uint8_t data) {
+	if (buffer_id >= RING_BUFFERS_COUNT) {
+		return;
+	}
 	ring_buffer_t* buffer = &ring_buffer[buffer_id];
 
-	if (buffer->tail != NULL && ring_buffer->tail->next == buffer->head) { // Buffer is overflow
+	TRACE_EVENT(TRACE_EVENT_RING_BUFFER_PUSH, buffer_id);
+	uint32_t state = BUFFER_LOCK(buffer);
+	if (buffer->tail != NULL && buffer->tail->next == buffer->head) { // Buffer is overflow
 		buffer->head = buffer->head->next;
 		buffer->tail = buffer->tail->next;
 		buffer->tail->data = data;
+		BUFFER_UNLOCK(buffer, state);
+		TRACE_EVENT(TRACE_EVENT_RING_BUFFER_OVERFLOW, buffer_id);
+		return; // Items count is not changed
 	}
 	else {
 		if (buffer->head == NULL) { // Insert first item as head of queue
@@ -70,6 +127,28 @@ void ring_buffer_push(ring_buffer_id buffer_id, uint8_t data) {
 			buffer->tail->data = data;
 		}
 	}
+
+	// Notifications
+	++buffer->count;
+	const ring_buffer_callbacks_t* callbacks = &buffer->callbacks;
+	ring_buffer_callback_t data_available = NULL;
+	ring_buffer_callback_t high_watermark = NULL;
+	void* context = callbacks->context;
+	if (buffer->count == 1) {
+		data_available = callbacks->data_available;
+	}
+	if (callbacks->high_level != 0 && buffer->count == callbacks->high_level && !buffer->is_high) {
+		buffer->is_high = true;
+		high_watermark = callbacks->high_watermark;
+	}
+	BUFFER_UNLOCK(buffer, state);
+
+	if (data_available != NULL) {
+		data_available(buffer_id, context);
+	}
+	if (high_watermark != NULL) {
+		high_watermark(buffer_id, context);
+	}
 }
 
 //  ***************************************************************************
@@ -79,9 +158,14 @@ void ring_buffer_push(ring_buffer_id buffer_id, uint8_t data) {
 /// @return true - pop success, false - ring buffer is empty
 //  ***************************************************************************
 bool ring_buffer_pop(ring_buffer_id buffer_id, uint8_t* data) {
+	if (buffer_id >= RING_BUFFERS_COUNT) {
+		return false;
+	}
 	ring_buffer_t* buffer = &ring_buffer[buffer_id];
 
+	uint32_t state = BUFFER_LOCK(buffer);
 	if (buffer->head == NULL) {
+		BUFFER_UNLOCK(buffer, state);
 		return false; // Queue is empty
 	}
 
@@ -96,6 +180,22 @@ bool ring_buffer_pop(ring_buffer_id buffer_id, uint8_t* data) {
 	else if (buffer->tail == NULL) {
 		buffer->head = NULL; // We read last item - remove head, ring buffer now is empty
 	}
+
+	// Notifications
+	--buffer->count;
+	const ring_buffer_callbacks_t* callbacks = &buffer->callbacks;
+	ring_buffer_callback_t low_watermark = NULL;
+	void* context = callbacks->context;
+	if (buffer->is_high && buffer->count <= callbacks->low_level) {
+		buffer->is_high = false;
+		low_watermark = callbacks->low_watermark;
+	}
+	BUFFER_UNLOCK(buffer, state);
+
+	TRACE_EVENT(TRACE_EVENT_RING_BUFFER_POP, buffer_id);
+	if (low_watermark != NULL) {
+		low_watermark(buffer_id, context);
+	}
 	return true;
 }
 
@@ -105,6 +205,9 @@ bool ring_buffer_pop(ring_buffer_id buffer_id, uint8_t* data) {
 /// @return true - queue is empty, false - otherwise
 //  ***************************************************************************
 bool ring_buffer_is_empty(ring_buffer_id buffer_id) {
+	if (buffer_id >= RING_BUFFERS_COUNT) {
+		return true;
+	}
 	return ring_buffer[buffer_id].head == NULL;
 }
 
@@ -117,6 +220,43 @@ void ring_buffer_clear(ring_buffer_id buffer_id) {
 	ring_buffer_init(buffer_id);
 }
 
+//  ***************************************************************************
+/// @brief  Get ring buffer items count
+/// @param  buffer_id: ring buffer id
+/// @return items count
+//  ***************************************************************************
+uint32_t ring_buffer_get_count(ring_buffer_id buffer_id) {
+	if (buffer_id >= RING_BUFFERS_COUNT) {
+		return 0;
+	}
+	return ring_buffer[buffer_id].count;
+}
+
+//  ***************************************************************************
+/// @brief  Set ring buffer notification callbacks
+/// @note   Callbacks are called from push/pop context and should be short
+///         (e.g. give semaphore or signal eventfd)
+/// @param  buffer_id: ring buffer id
+/// @param  callbacks: callbacks description, NULL - disable notifications
+/// @return none
+//  ***************************************************************************
+void ring_buffer_set_callbacks(ring_buffer_id buffer_id, const ring_buffer_callbacks_t* callbacks) {
+	if (buffer_id >= RING_BUFFERS_COUNT) {
+		return;
+	}
+	ring_buffer_t* buffer = &ring_buffer[buffer_id];
+
+	uint32_t state = BUFFER_LOCK(buffer);
+	if (callbacks != NULL) {
+		buffer->callbacks = *callbacks;
+	}
+	else {
+		memset(&buffer->callbacks, 0, sizeof(ring_buffer_callbacks_t));
+	}
+	buffer->is_high = (buffer->callbacks.high_level != 0 && buffer->count >= buffer->callbacks.high_level);
+	BUFFER_UNLOCK(buffer, state);
+}
+
 
 /*#include <stdio.h>
 void ring_buffer_print(ring_buffer_id buffer_id) {
@@ -17,11 +17,27 @@ typedef enum {
 	RING_BUFFERS_COUNT
 } ring_buffer_id;
 
+// Notification callback. Called from ring_buffer_push/ring_buffer_pop context (can be ISR)
+// outside of buffer lock, so callback can push/pop or take RTOS objects
+typedef void(*ring_buffer_callback_t)(ring_buffer_id buffer_id, void* context);
+
+// Consumer/producer notifications (any callback can be NULL)
+typedef struct {
+	ring_buffer_callback_t data_available;   // Buffer goes from empty to non-empty
+	ring_buffer_callback_t high_watermark;   // Items count rises to high_level
+	ring_buffer_callback_t low_watermark;    // Items count falls to low_level after high watermark
+	uint32_t high_level;                     // High watermark level, 0 - disabled
+	uint32_t low_level;                      // Low watermark level (should be less than high_level)
+	void* context;                           // User context for callbacks
+} ring_buffer_callbacks_t;
+
 extern void ring_buffer_init(ring_buffer_id buffer_id);
 extern void ring_buffer_push(ring_buffer_id buffer_id, uint8_t data);
 extern bool ring_buffer_pop(ring_buffer_id buffer_id, uint8_t* data);
 extern bool ring_buffer_is_empty(ring_buffer_id buffer_id);
 extern void ring_buffer_clear(ring_buffer_id buffer_id);
+extern uint32_t ring_buffer_get_count(ring_buffer_id buffer_id);
+extern void ring_buffer_set_callbacks(ring_buffer_id buffer_id, const ring_buffer_callbacks_t* callbacks);
 
 //extern void ring_buffer_print(ring_buffer_id buffer_id);
 
@@ -0,0 +1,178 @@
+//  ***************************************************************************
+/// @file    ring_buffer_mirror.c
+/// @author  NeoProg
+//  ***************************************************************************
+#ifdef __linux__
+#define _GNU_SOURCE
+#include "ring_buffer_mirror.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+
+//  ***************************************************************************
+/// @brief  Ring buffer initialization
+/// @param  buffer: ring buffer
+/// @param  size: buffer size (will be rounded up to power of 2 and not less than page size, max 1 GiB)
+/// @return true - success, false - fail
+//  ***************************************************************************
+bool ring_buffer_mirror_init(ring_buffer_mirror_t* buffer, uint32_t size) {
+	memset(buffer, 0, sizeof(ring_buffer_mirror_t));
+
+	// Free running positions wrap at 2^32: offset (position & (size - 1)) is continuous only if size is power of 2
+	uint32_t page_size = (uint32_t)sysconf(_SC_PAGESIZE);
+	if (size == 0 || size > (1u << 30)) {
+		return false;
+	}
+	uint32_t rounded_size = page_size;
+	while (rounded_size < size) {
+		rounded_size <<= 1;
+	}
+	size = rounded_size;
+
+	int fd = memfd_create("ring_buffer_mirror", MFD_CLOEXEC);
+	if (fd < 0) {
+		return false;
+	}
+	if (ftruncate(fd, size) != 0) {
+		close(fd);
+		return false;
+	}
+
+	// Reserve address space for two copies and map same file pages twice: [pages][pages]
+	uint8_t* memory = mmap(NULL, 2 * (size_t)size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (memory == MAP_FAILED) {
+		close(fd);
+		return false;
+	}
+	if (mmap(memory, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+		mmap(memory + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+		munmap(memory, 2 * (size_t)size);
+		close(fd);
+		return false;
+	}
+	close(fd); // Mappings keep pages
+
+	buffer->buffer = memory;
+	buffer->size = size;
+	return true;
+}
+
+//  ***************************************************************************
+/// @brief  Ring buffer deinitialization
+/// @param  buffer: ring buffer
+/// @return none
+//  ***************************************************************************
+void ring_buffer_mirror_deinit(ring_buffer_mirror_t* buffer) {
+	if (buffer->buffer != NULL) {
+		munmap(buffer->buffer, 2 * (size_t)buffer->size);
+	}
+	memset(buffer, 0, sizeof(ring_buffer_mirror_t));
+}
+
+//  ***************************************************************************
+/// @brief  Get contiguous region for write (producer)
+/// @param  buffer: ring buffer
+/// @param  free_size: region size
+/// @return pointer to region
+//  ***************************************************************************
+uint8_t* ring_buffer_mirror_get_write_region(ring_buffer_mirror_t* buffer, uint32_t* free_size) {
+	uint32_t head = __atomic_load_n(&buffer->head, __ATOMIC_ACQUIRE);
+	uint32_t tail = buffer->tail;
+	*free_size = buffer->size - (tail - head);
+	return &buffer->buffer[tail & (buffer->size - 1)];
+}
+
+//  ***************************************************************************
+/// @brief  Commit written data (producer)
+/// @param  buffer: ring buffer
+/// @param  size: written bytes count (should not be greater than free size)
+/// @return none
+//  ***************************************************************************
+void ring_buffer_mirror_commit(ring_buffer_mirror_t* buffer, uint32_t size) {
+	__atomic_store_n(&buffer->tail, buffer->tail + size, __ATOMIC_RELEASE);
+}
+
+//  ***************************************************************************
+/// @brief  Get contiguous region for read (consumer)
+/// @param  buffer: ring buffer
+/// @param  data_size: region size
+/// @return pointer to region
+//  ***************************************************************************
+const uint8_t* ring_buffer_mirror_get_read_region(ring_buffer_mirror_t* buffer, uint32_t* data_size) {
+	uint32_t tail = __atomic_load_n(&buffer->tail, __ATOMIC_ACQUIRE);
+	uint32_t head = buffer->head;
+	*data_size = tail - head;
+	return &buffer->buffer[head & (buffer->size - 1)];
+}
+
+//  ***************************************************************************
+/// @brief  Release read data (consumer)
+/// @param  buffer: ring buffer
+/// @param  size: read bytes count (should not be greater than data size)
+/// @return none
+//  ***************************************************************************
+void ring_buffer_mirror_consume(ring_buffer_mirror_t* buffer, uint32_t size) {
+	__atomic_store_n(&buffer->head, buffer->head + size, __ATOMIC_RELEASE);
+}
+
+//  ***************************************************************************
+/// @brief  Push data to ring buffer (single memcpy)
+/// @param  buffer: ring buffer
+/// @param  data: data for enqueue
+/// @param  size: data size
+/// @return pushed bytes count (less than size if buffer is full)
+//  ***************************************************************************
+uint32_t ring_buffer_mirror_push(ring_buffer_mirror_t* buffer, const uint8_t* data, uint32_t size) {
+	uint32_t free_size = 0;
+	uint8_t* region = ring_buffer_mirror_get_write_region(buffer, &free_size);
+	if (size > free_size) {
+		size = free_size;
+	}
+	memcpy(region, data, size);
+	ring_buffer_mirror_commit(buffer, size);
+	return size;
+}
+
+//  ***************************************************************************
+/// @brief  Pop data from ring buffer (single memcpy)
+/// @param  buffer: ring buffer
+/// @param  data: buffer for data
+/// @param  size: buffer size
+/// @return popped bytes count
+//  ***************************************************************************
+uint32_t ring_buffer_mirror_pop(ring_buffer_mirror_t* buffer, uint8_t* data, uint32_t size) {
+	uint32_t data_size = 0;
+	const uint8_t* region = ring_buffer_mirror_get_read_region(buffer, &data_size);
+	if (size > data_size) {
+		size = data_size;
+	}
+	memcpy(data, region, size);
+	ring_buffer_mirror_consume(buffer, size);
+	return size;
+}
+
+//  ***************************************************************************
+/// @brief  Check ring buffer empty
+/// @param  buffer: ring buffer
+/// @return true - buffer is empty, false - otherwise
+//  ***************************************************************************
+bool ring_buffer_mirror_is_empty(ring_buffer_mirror_t* buffer) {
+	return __atomic_load_n(&buffer->tail, __ATOMIC_ACQUIRE) == __atomic_load_n(&buffer->head, __ATOMIC_ACQUIRE);
+}
+
+//  ***************************************************************************
+/// @brief  Clear ring buffer (producer and consumer should be stopped)
+/// @param  buffer: ring buffer
+/// @return none
+//  ***************************************************************************
+void ring_buffer_mirror_clear(ring_buffer_mirror_t* buffer) {
+	buffer->head = 0;
+	buffer->tail = 0;
+}
+
+
+#endif // __linux__
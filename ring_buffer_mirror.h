@@ -0,0 +1,37 @@
+//  ***************************************************************************
+/// @file    ring_buffer_mirror.h
+/// @author  NeoProg
+/// @brief   Double-mapped ring buffer (Linux host only)
+/// @note    Buffer pages are mapped twice back to back, so each read and write
+///          region is contiguous regardless of wrap. Single producer and single
+///          consumer can work from different threads
+//  ***************************************************************************
+#ifndef _RING_BUFFER_MIRROR_H_
+#define _RING_BUFFER_MIRROR_H_
+#ifdef __linux__
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+	uint8_t* buffer;    // Buffer memory: [0...size-1] and [size...2*size-1] are same pages
+	uint32_t size;      // Buffer size (power of 2, multiple of page size)
+	uint32_t head;      // Read position (free running, owned by consumer)
+	uint32_t tail;      // Write position (free running, owned by producer)
+} ring_buffer_mirror_t;
+
+extern bool ring_buffer_mirror_init(ring_buffer_mirror_t* buffer, uint32_t size);
+extern void ring_buffer_mirror_deinit(ring_buffer_mirror_t* buffer);
+
+extern uint8_t* ring_buffer_mirror_get_write_region(ring_buffer_mirror_t* buffer, uint32_t* free_size);
+extern void ring_buffer_mirror_commit(ring_buffer_mirror_t* buffer, uint32_t size);
+extern const uint8_t* ring_buffer_mirror_get_read_region(ring_buffer_mirror_t* buffer, uint32_t* data_size);
+extern void ring_buffer_mirror_consume(ring_buffer_mirror_t* buffer, uint32_t size);
+
+extern uint32_t ring_buffer_mirror_push(ring_buffer_mirror_t* buffer, const uint8_t* data, uint32_t size);
+extern uint32_t ring_buffer_mirror_pop(ring_buffer_mirror_t* buffer, uint8_t* data, uint32_t size);
+extern bool ring_buffer_mirror_is_empty(ring_buffer_mirror_t* buffer);
+extern void ring_buffer_mirror_clear(ring_buffer_mirror_t* buffer);
+
+
+#endif // __linux__
+#endif // _RING_BUFFER_MIRROR_H_
@@ -0,0 +1,286 @@
+//  ***************************************************************************
+/// @file    cli_replay.c
+/// @author  NeoProg
+/// @brief   Keystroke trace replay harness: CLI session with VEEPROM commands
+///          on simulated FLASH, input is passed through ring buffer (RX ISR
+///          model) directly or through pseudo terminal
+/// @note    Usage: cli_replay [--pty] [output.json] trace.keys [trace.keys...]
+///          Trace is raw keystrokes file. Main loop model: pop all received
+///          symbols and call cli_core_process() once per received symbol
+//  ***************************************************************************
+#define _GNU_SOURCE
+#include "bench.h"
+#include "cli_core.h"
+#include "ring_buffer.h"
+#include "veeprom_cli.h"
+#include "veeprom_fixture.h"
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#define FLASH_PAGE_SIZE                     (1024)
+#define FLASH_PROGRAM_WIDTH                 (2)
+#define MAX_TRACE_SIZE                      (65536)
+
+
+typedef struct {
+    uint8_t* keys;
+    uint32_t keys_count;
+    uint64_t* cpu_samples;                              // CPU time per keystroke
+    uint64_t* latency_samples;                          // Keystroke latency (direct: processing time, pty: write to processed)
+    int slave_fd;
+    sem_t processed;                                    // Keystroke is processed by device (pty mode)
+} replay_t;
+
+
+static bool replay_trace(const char* path, bool is_pty);
+static void replay_direct(replay_t* replay);
+static bool replay_pty(replay_t* replay);
+static void* device_thread(void* arg);
+static void device_receive(uint8_t symbol);
+static void device_send_data(void* context, const char* data);
+
+
+static const cli_cmd_t cmd_list[] = {
+    VEEPROM_CLI_CMD
+};
+static cli_session_t session;
+static veeprom_t veeprom;
+
+
+int main(int argc, char* argv[]) {
+    const char* output_path = NULL;
+    bool is_pty = false;
+    int first_trace = 1;
+    for (; first_trace < argc; ++first_trace) {
+        if (strcmp(argv[first_trace], "--pty") == 0) {
+            is_pty = true;
+        }
+        else if (strstr(argv[first_trace], ".json") != NULL) {
+            output_path = argv[first_trace];
+        }
+        else {
+            break;
+        }
+    }
+    if (first_trace >= argc) {
+        fprintf(stderr, "Usage: cli_replay [--pty] [output.json] trace.keys [trace.keys...]\n");
+        return 1;
+    }
+
+    cli_core_register_commands(cmd_list, sizeof(cmd_list) / sizeof(cmd_list[0]));
+    veeprom_cli_attach(&veeprom);
+
+    for (int i = first_trace; i < argc; ++i) {
+        if (!replay_trace(argv[i], is_pty)) {
+            return 1;
+        }
+    }
+    return bench_save_report(output_path) ? 0 : 1;
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Replay trace in new session and report results
+/// @param  path: trace file path
+/// @param  is_pty: true - pass keystrokes through pseudo terminal
+/// @return true - success, false - trace load or replay error
+//  ***************************************************************************
+static bool replay_trace(const char* path, bool is_pty) {
+    replay_t replay = {0};
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        perror(path);
+        return false;
+    }
+    replay.keys = malloc(MAX_TRACE_SIZE);
+    replay.keys_count = fread(replay.keys, 1, MAX_TRACE_SIZE, file);
+    fclose(file);
+    if (replay.keys_count == 0) {
+        fprintf(stderr, "%s: empty trace\n", path);
+        free(replay.keys);
+        return false;
+    }
+    replay.cpu_samples = malloc(sizeof(uint64_t) * replay.keys_count);
+    replay.latency_samples = malloc(sizeof(uint64_t) * replay.keys_count);
+
+    // Device: erased FLASH, new session and empty RX buffer
+    veeprom_config_t config;
+    veeprom_fixture_init(&veeprom, &config, FLASH_PAGE_SIZE, 1, FLASH_PROGRAM_WIDTH, NULL);
+    ring_buffer_init(RING_BUFFER_1);
+    replay.slave_fd = -1;
+    cli_core_init(&session, device_send_data, &replay.slave_fd);
+
+    bool is_ok = true;
+    if (is_pty) {
+        is_ok = replay_pty(&replay);
+    }
+    else {
+        replay_direct(&replay);
+    }
+    while (session.running_cmd != NULL) { // Finish command started by last keystrokes
+        cli_core_process(&session);
+    }
+
+    if (is_ok) {
+        char trace_name[64];
+        char name[128];
+        char* path_copy = strdup(path);
+        snprintf(trace_name, sizeof(trace_name), "%s", basename(path_copy));
+        free(path_copy);
+        char* extension = strrchr(trace_name, '.');
+        if (extension != NULL) {
+            *extension = 0;
+        }
+
+        cli_stats_t stats;
+        cli_core_get_stats(&session, &stats);
+        const char* prefix = is_pty ? "replay.pty" : "replay";
+        snprintf(name, sizeof(name), "%s.%s.cpu_per_key.p50", prefix, trace_name);
+        bench_report(name, bench_percentile(replay.cpu_samples, replay.keys_count, 50), "ns", true);
+        snprintf(name, sizeof(name), "%s.%s.cpu_per_key.p99", prefix, trace_name);
+        bench_report(name, bench_percentile(replay.cpu_samples, replay.keys_count, 99), "ns", true);
+        snprintf(name, sizeof(name), "%s.%s.latency.p50", prefix, trace_name);
+        bench_report(name, bench_percentile(replay.latency_samples, replay.keys_count, 50), "ns", true);
+        snprintf(name, sizeof(name), "%s.%s.latency.p99", prefix, trace_name);
+        bench_report(name, bench_percentile(replay.latency_samples, replay.keys_count, 99), "ns", true);
+        snprintf(name, sizeof(name), "%s.%s.bytes_per_key", prefix, trace_name);
+        bench_report(name, (double)stats.tx_bytes / replay.keys_count, "bytes", true);
+        snprintf(name, sizeof(name), "%s.%s.calls_per_key", prefix, trace_name);
+        bench_report(name, (double)stats.tx_calls / replay.keys_count, "calls", true);
+    }
+
+    veeprom_flash_sim_deinit();
+    free(replay.keys);
+    free(replay.cpu_samples);
+    free(replay.latency_samples);
+    return is_ok;
+}
+
+//  ***************************************************************************
+/// @brief  Replay trace: keystrokes are passed to device in current thread
+/// @param  replay: replay context
+/// @return none
+//  ***************************************************************************
+static void replay_direct(replay_t* replay) {
+    for (uint32_t i = 0; i < replay->keys_count; ++i) {
+        uint64_t begin = bench_get_time_ns();
+        uint64_t cpu_begin = bench_get_cpu_time_ns();
+        device_receive(replay->keys[i]);
+        replay->cpu_samples[i] = bench_get_cpu_time_ns() - cpu_begin;
+        replay->latency_samples[i] = bench_get_time_ns() - begin;
+    }
+}
+
+//  ***************************************************************************
+/// @brief  Replay trace: keystrokes are written to master side of pseudo
+///         terminal, device thread reads slave side
+/// @param  replay: replay context
+/// @return true - success, false - pseudo terminal error
+//  ***************************************************************************
+static bool replay_pty(replay_t* replay) {
+    int master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master_fd < 0 || grantpt(master_fd) != 0 || unlockpt(master_fd) != 0) {
+        perror("posix_openpt");
+        return false;
+    }
+    replay->slave_fd = open(ptsname(master_fd), O_RDWR | O_NOCTTY);
+    if (replay->slave_fd < 0) {
+        perror("ptsname");
+        close(master_fd);
+        return false;
+    }
+    struct termios tio;
+    tcgetattr(replay->slave_fd, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(replay->slave_fd, TCSANOW, &tio);
+
+    sem_init(&replay->processed, 0, 0);
+    pthread_t thread;
+    pthread_create(&thread, NULL, device_thread, replay);
+
+    bool is_ok = true;
+    char output[256];
+    struct pollfd pfd = { .fd = master_fd, .events = POLLIN };
+    for (uint32_t i = 0; i < replay->keys_count && is_ok; ++i) {
+        uint64_t begin = bench_get_time_ns();
+        is_ok = write(master_fd, &replay->keys[i], 1) == 1;
+        sem_wait(&replay->processed);
+        replay->latency_samples[i] = bench_get_time_ns() - begin;
+
+        while (poll(&pfd, 1, 0) > 0 && read(master_fd, output, sizeof(output)) > 0); // Drain terminal output
+    }
+
+    close(master_fd); // Device thread read fails after master close
+    pthread_join(thread, NULL);
+    sem_destroy(&replay->processed);
+    close(replay->slave_fd);
+    replay->slave_fd = -1;
+    return is_ok;
+}
+
+//  ***************************************************************************
+/// @brief  Device thread: read slave side of pseudo terminal
+/// @param  arg: replay context
+//  ***************************************************************************
+static void* device_thread(void* arg) {
+    replay_t* replay = (replay_t*)arg;
+    uint8_t symbol;
+    for (uint32_t i = 0; read(replay->slave_fd, &symbol, 1) == 1; ++i) {
+        uint64_t cpu_begin = bench_get_cpu_time_ns();
+        device_receive(symbol);
+        if (i < replay->keys_count) {
+            replay->cpu_samples[i] = bench_get_cpu_time_ns() - cpu_begin;
+        }
+        sem_post(&replay->processed);
+    }
+    return NULL;
+}
+
+//  ***************************************************************************
+/// @brief  Device receive path: RX ISR puts symbol to ring buffer, main loop
+///         pops received symbols and processes running command
+/// @param  symbol: received symbol
+/// @return none
+//  ***************************************************************************
+static void device_receive(uint8_t symbol) {
+    ring_buffer_push(RING_BUFFER_1, symbol);
+
+    uint8_t data = 0;
+    while (ring_buffer_pop(RING_BUFFER_1, &data)) {
+        cli_core_symbol_received(&session, (char)data);
+    }
+    cli_core_process(&session);
+}
+
+//  ***************************************************************************
+/// @brief  Send data callback: write to slave side of pseudo terminal (pty mode)
+/// @param  context: pointer to slave file descriptor (-1 - output is dropped)
+/// @param  data: null-terminated string
+//  ***************************************************************************
+static void device_send_data(void* context, const char* data) {
+    int fd = *(int*)context;
+    if (fd < 0) {
+        return;
+    }
+    uint32_t size = strlen(data);
+    while (size > 0) {
+        ssize_t count = write(fd, data, size);
+        if (count <= 0) {
+            return;
+        }
+        data += count;
+        size -= count;
+    }
+}
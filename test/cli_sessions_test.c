@@ -0,0 +1,174 @@
+//  ***************************************************************************
+/// @file    cli_sessions_test.c
+/// @author  NeoProg
+/// @brief   Concurrent CLI sessions test: each thread drives own session and
+///          checks output isolation and keystroke-to-echo latency
+/// @note    Usage: cli_sessions_test [--quick] [output.json]
+//  ***************************************************************************
+#include "bench.h"
+#include "cli_core.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+
+#define SESSIONS_COUNT                      (64)
+#define ROUNDS_COUNT                        (200)
+#define MAX_KEYS_PER_ROUND                  (32)
+#define MAX_OUTPUT_SIZE                     (256)
+#define GREETING_STRING                     ("\x1B[36mroot@hexapod-AIWM: \x1B[0m")
+
+
+typedef struct {
+    cli_session_t session;
+    uint32_t index;
+    char output[MAX_OUTPUT_SIZE];                       // Output of current round
+    uint32_t output_length;
+    uint64_t key_time;                                  // Keystroke timestamp, 0 - echo is received
+    uint64_t* samples;                                  // Keystroke-to-echo latency samples
+    uint32_t samples_count;
+    uint32_t errors_count;
+} terminal_t;
+
+
+static cli_cmd_status_t echo_handler(cli_session_t* session, int32_t argc, char* argv[]);
+static void* terminal_thread(void* arg);
+static void send_data(void* context, const char* data);
+
+
+static const cli_cmd_t cmd_list[] = {
+    { .name = "echo", .args = NULL, .handler = echo_handler }
+};
+static terminal_t terminals[SESSIONS_COUNT];
+static pthread_barrier_t start_barrier;
+static uint32_t rounds_count = 0;
+
+
+int main(int argc, char* argv[]) {
+    const char* output_path = NULL;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            bench_set_quick_mode(true);
+        }
+        else {
+            output_path = argv[i];
+        }
+    }
+    rounds_count = bench_iterations(ROUNDS_COUNT);
+
+    // Command registry is shared between sessions and must be built before sessions start
+    cli_core_register_commands(cmd_list, sizeof(cmd_list) / sizeof(cmd_list[0]));
+
+    pthread_t threads[SESSIONS_COUNT];
+    pthread_barrier_init(&start_barrier, NULL, SESSIONS_COUNT);
+    for (uint32_t i = 0; i < SESSIONS_COUNT; ++i) {
+        terminals[i].index = i;
+        terminals[i].samples = malloc(sizeof(uint64_t) * rounds_count * MAX_KEYS_PER_ROUND);
+        pthread_create(&threads[i], NULL, terminal_thread, &terminals[i]);
+    }
+
+    uint32_t errors_count = 0;
+    uint32_t samples_count = 0;
+    uint64_t* samples = malloc(sizeof(uint64_t) * SESSIONS_COUNT * rounds_count * MAX_KEYS_PER_ROUND);
+    for (uint32_t i = 0; i < SESSIONS_COUNT; ++i) {
+        pthread_join(threads[i], NULL);
+        errors_count += terminals[i].errors_count;
+        memcpy(&samples[samples_count], terminals[i].samples, sizeof(uint64_t) * terminals[i].samples_count);
+        samples_count += terminals[i].samples_count;
+        free(terminals[i].samples);
+    }
+    pthread_barrier_destroy(&start_barrier);
+
+    bench_report("cli.sessions.echo_latency.p50", bench_percentile(samples, samples_count, 50) / 1000.0, "us", true);
+    bench_report("cli.sessions.echo_latency.p99", bench_percentile(samples, samples_count, 99) / 1000.0, "us", true);
+    bench_report("cli.sessions.echo_latency.max", bench_percentile(samples, samples_count, 100) / 1000.0, "us", true);
+    free(samples);
+    if (!bench_save_report(output_path)) {
+        return 1;
+    }
+
+    if (errors_count != 0) {
+        fprintf(stderr, "%u session output mismatches\n", errors_count);
+        return 1;
+    }
+    return 0;
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Print first argument
+//  ***************************************************************************
+static cli_cmd_status_t echo_handler(cli_session_t* session, int32_t argc, char* argv[]) {
+    if (argc > 1) {
+        cli_core_send(session, argv[1]);
+    }
+    cli_core_send(session, "\r\n");
+    return CLI_CMD_DONE;
+}
+
+//  ***************************************************************************
+/// @brief  Terminal thread: type unique command in own session and check output
+/// @param  arg: terminal context
+//  ***************************************************************************
+static void* terminal_thread(void* arg) {
+    terminal_t* terminal = (terminal_t*)arg;
+    char keys[MAX_KEYS_PER_ROUND];
+    char token[16];
+    char expected[MAX_OUTPUT_SIZE];
+
+    cli_core_init(&terminal->session, send_data, terminal);
+    pthread_barrier_wait(&start_barrier);
+
+    for (uint32_t round = 0; round < rounds_count; ++round) {
+        snprintf(token, sizeof(token), "s%u_%u", terminal->index, round);
+        snprintf(keys, sizeof(keys), "echo %s\r", token);
+        snprintf(expected, sizeof(expected), "echo %s\r\n%s\r\n%s", token, token, GREETING_STRING);
+        terminal->output_length = 0;
+
+        for (const char* p = keys; *p != 0; ++p) {
+            uint32_t output_length = terminal->output_length;
+            terminal->key_time = bench_get_time_ns();
+            cli_core_symbol_received(&terminal->session, *p);
+            if (terminal->key_time != 0 || terminal->output_length == output_length) {
+                ++terminal->errors_count; // No echo
+            }
+            if (*p != '\r' && (terminal->output_length != output_length + 1 || terminal->output[output_length] != *p)) {
+                ++terminal->errors_count; // Echo is not equal to typed symbol
+            }
+        }
+        while (terminal->session.running_cmd != NULL) {
+            cli_core_process(&terminal->session);
+        }
+
+        if (terminal->output_length != strlen(expected) || memcmp(terminal->output, expected, terminal->output_length) != 0) {
+            ++terminal->errors_count;
+        }
+    }
+    return NULL;
+}
+
+//  ***************************************************************************
+/// @brief  Send data callback: collect round output and take echo timestamp
+/// @param  context: terminal context
+/// @param  data: null-terminated string
+//  ***************************************************************************
+static void send_data(void* context, const char* data) {
+    terminal_t* terminal = (terminal_t*)context;
+    if (terminal->key_time != 0) {
+        terminal->samples[terminal->samples_count++] = bench_get_time_ns() - terminal->key_time;
+        terminal->key_time = 0;
+    }
+
+    uint32_t length = strlen(data);
+    if (terminal->output_length + length > MAX_OUTPUT_SIZE) {
+        ++terminal->errors_count;
+        return;
+    }
+    memcpy(&terminal->output[terminal->output_length], data, length);
+    terminal->output_length += length;
+}
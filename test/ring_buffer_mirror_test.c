@@ -0,0 +1,61 @@
+//  ***************************************************************************
+/// @file    ring_buffer_mirror_test.c
+/// @author  NeoProg
+/// @brief   Double-mapped ring buffer test: data order across 2^32 position
+///          wrap for size which is not power of 2 before rounding
+//  ***************************************************************************
+#include "ring_buffer_mirror.h"
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#define CHUNK_MAX_SIZE                      (5000)
+
+
+int main(void) {
+    ring_buffer_mirror_t buffer;
+    uint32_t page_size = (uint32_t)sysconf(_SC_PAGESIZE);
+    if (!ring_buffer_mirror_init(&buffer, 3 * page_size)) {
+        fprintf(stderr, "init failed\n");
+        return 1;
+    }
+    if (buffer.size != 4 * page_size) {
+        fprintf(stderr, "size %u is not rounded to power of 2\n", buffer.size);
+        return 1;
+    }
+
+    // Start near position counter overflow
+    buffer.head = buffer.tail = UINT32_MAX - buffer.size / 2;
+
+    uint8_t chunk[CHUNK_MAX_SIZE];
+    uint8_t write_value = 0;
+    uint8_t read_value = 0;
+    uint64_t total = 0;
+    srand(1);
+    while (total < 8ull * buffer.size) {
+        uint32_t size = 1 + rand() % CHUNK_MAX_SIZE;
+        for (uint32_t i = 0; i < size; ++i) {
+            chunk[i] = write_value++;
+        }
+        uint32_t pushed = ring_buffer_mirror_push(&buffer, chunk, size);
+        write_value -= size - pushed;
+
+        uint32_t popped = ring_buffer_mirror_pop(&buffer, chunk, 1 + rand() % CHUNK_MAX_SIZE);
+        for (uint32_t i = 0; i < popped; ++i) {
+            if (chunk[i] != read_value++) {
+                fprintf(stderr, "data mismatch at %llu (head 0x%08X)\n", (unsigned long long)(total + i), buffer.head);
+                return 1;
+            }
+        }
+        total += popped;
+    }
+    if (buffer.head > UINT32_MAX / 2) {
+        fprintf(stderr, "position did not wrap\n");
+        return 1;
+    }
+
+    ring_buffer_mirror_deinit(&buffer);
+    return 0;
+}
@@ -0,0 +1,370 @@
+//  ***************************************************************************
+/// @file    veeprom_test.c
+/// @author  NeoProg
+/// @brief   VEEPROM regression test on simulated FLASH: data read back for all
+///          program widths and page counts, write-back coalescing and power
+///          fail flush during running page swap
+//  ***************************************************************************
+#include "veeprom_fixture.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#define FLASH_PAGE_SIZE                     (1024)
+#define WRITES_COUNT                        (64)
+#define WRITE_MAX_SIZE                      (24)
+
+
+typedef struct {
+    veeprom_t* veeprom;
+    uint32_t fire_program_count;                        // Program operation for call handler
+    bool is_fired;
+    bool is_nested_program;                             // Handler did program operation
+    bool is_flush_pending;                              // Flush is deferred by handler
+    bool is_nested_write;                               // Write from hook is done
+} hook_context_t;
+
+
+static bool test_read_back(uint32_t page_count, uint32_t program_width);
+static bool test_write_back(uint32_t program_width);
+static bool test_power_fail(uint32_t program_width);
+static bool test_nested_write(void);
+static bool test_time_source(void);
+
+static void random_fill(veeprom_t* veeprom, uint8_t* model);
+static void random_write(veeprom_t* veeprom, uint8_t* model);
+static bool check_contents(const char* test, const veeprom_t* veeprom, const veeprom_config_t* config, const uint8_t* model);
+static void power_fail_hook(uint32_t program_count, void* context);
+static void nested_write_hook(uint32_t program_count, void* context);
+
+
+static uint8_t cache[FLASH_PAGE_SIZE * 2];
+static uint8_t model[FLASH_PAGE_SIZE * 2];
+
+
+int main(void) {
+    static const uint32_t widths[] = { 2, 4, 8 };
+    srand(1);
+    for (uint32_t i = 0; i < sizeof(widths) / sizeof(widths[0]); ++i) {
+        if (!test_read_back(1, widths[i]) || !test_read_back(2, widths[i]) ||
+            !test_write_back(widths[i]) || !test_power_fail(widths[i])) {
+            return 1;
+        }
+    }
+    if (!test_nested_write() || !test_time_source()) {
+        return 1;
+    }
+    return 0;
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Write-through: random writes are read back (before and after init)
+/// @param  page_count: FLASH pages count in VEEPROM page
+/// @param  program_width: FLASH program unit size
+/// @return true - success, false - fail
+//  ***************************************************************************
+static bool test_read_back(uint32_t page_count, uint32_t program_width) {
+    veeprom_t veeprom;
+    veeprom_config_t config;
+    if (!veeprom_fixture_init(&veeprom, &config, FLASH_PAGE_SIZE, page_count, program_width, NULL)) {
+        fprintf(stderr, "read_back: init failed (width %u, pages %u)\n", program_width, page_count);
+        return false;
+    }
+    memset(model, 0xFF, veeprom_get_size(&veeprom));
+    for (uint32_t i = 0; i < WRITES_COUNT; ++i) {
+        random_write(&veeprom, model);
+    }
+    veeprom_stat_t stat;
+    veeprom_get_stat(&veeprom, &stat);
+    bool is_ok = check_contents("read_back", &veeprom, &config, model);
+    if (stat.write_count != WRITES_COUNT || stat.page_swap_count != WRITES_COUNT) {
+        fprintf(stderr, "read_back: %u writes and %u swaps for %u writes\n", stat.write_count, stat.page_swap_count, WRITES_COUNT);
+        is_ok = false;
+    }
+    if (!is_ok) {
+        fprintf(stderr, "read_back: failed (width %u, pages %u)\n", program_width, page_count);
+    }
+    veeprom_flash_sim_deinit();
+    return is_ok;
+}
+
+//  ***************************************************************************
+/// @brief  Write-back: writes are coalesced in RAM image, one swap per flush
+/// @param  program_width: FLASH program unit size
+/// @return true - success, false - fail
+//  ***************************************************************************
+static bool test_write_back(uint32_t program_width) {
+    veeprom_t veeprom;
+    veeprom_config_t config;
+    if (!veeprom_fixture_init(&veeprom, &config, FLASH_PAGE_SIZE, 1, program_width, cache)) {
+        fprintf(stderr, "write_back: init failed (width %u)\n", program_width);
+        return false;
+    }
+    uint32_t size = veeprom_get_size(&veeprom);
+    memset(model, 0xFF, size);
+    for (uint32_t i = 0; i < WRITES_COUNT; ++i) {
+        random_write(&veeprom, model);
+    }
+
+    bool is_ok = true;
+    veeprom_stat_t stat;
+    veeprom_get_stat(&veeprom, &stat);
+    if (stat.page_swap_count != 0 || !stat.is_dirty) {
+        fprintf(stderr, "write_back: %u swaps before flush, dirty %d\n", stat.page_swap_count, stat.is_dirty);
+        is_ok = false;
+    }
+    uint8_t* data = malloc(size);
+    if (!veeprom_read(&veeprom, 0, data, size) || memcmp(data, model, size) != 0) {
+        fprintf(stderr, "write_back: RAM image mismatch\n");
+        is_ok = false;
+    }
+    free(data);
+
+    // Second flush has nothing to write
+    if (!veeprom_flush(&veeprom) || !veeprom_flush(&veeprom)) {
+        fprintf(stderr, "write_back: flush failed\n");
+        is_ok = false;
+    }
+    veeprom_get_stat(&veeprom, &stat);
+    if (stat.page_swap_count != 1 || stat.is_dirty) {
+        fprintf(stderr, "write_back: %u swaps after flush, dirty %d\n", stat.page_swap_count, stat.is_dirty);
+        is_ok = false;
+    }
+    if (!check_contents("write_back", &veeprom, &config, model)) {
+        is_ok = false;
+    }
+    if (!is_ok) {
+        fprintf(stderr, "write_back: failed (width %u)\n", program_width);
+    }
+    veeprom_flash_sim_deinit();
+    return is_ok;
+}
+
+//  ***************************************************************************
+/// @brief  Power fail handler is called on each program operation of flush:
+///         it should not start nested swap and data should be complete after it
+/// @param  program_width: FLASH program unit size
+/// @return true - success, false - fail
+//  ***************************************************************************
+static bool test_power_fail(uint32_t program_width) {
+    veeprom_t veeprom;
+    veeprom_config_t config;
+    bool is_ok = true;
+    bool is_swap_end = false;
+    for (uint32_t i = 1; !is_swap_end && is_ok; ++i) {
+        // Page is filled by random data: most units are programmed on each swap
+        if (!veeprom_fixture_init(&veeprom, &config, FLASH_PAGE_SIZE, 1, program_width, cache)) {
+            fprintf(stderr, "power_fail: init failed (width %u)\n", program_width);
+            return false;
+        }
+        random_fill(&veeprom, model);
+        veeprom_flush(&veeprom);
+        random_write(&veeprom, model);
+
+        hook_context_t context = { .veeprom = &veeprom, .fire_program_count = i };
+        veeprom_flash_sim_reset_stat();
+        veeprom_flash_sim_set_program_hook(power_fail_hook, &context);
+        bool result = veeprom_flush(&veeprom);
+        veeprom_flash_sim_set_program_hook(NULL, NULL);
+
+        veeprom_flash_sim_stat_t flash_stat;
+        veeprom_flash_sim_get_stat(&flash_stat);
+        is_swap_end = flash_stat.program_count < i; // Each program operation of swap is interrupted
+        veeprom_stat_t stat;
+        veeprom_get_stat(&veeprom, &stat);
+        if (!result || context.is_fired == is_swap_end || context.is_nested_program || context.is_flush_pending == is_swap_end ||
+            veeprom.is_flush_pending || veeprom.is_busy || stat.page_swap_count != 2 || stat.is_dirty) {
+            fprintf(stderr, "power_fail: program %u: result %d, fired %d, nested %d, pending %d, swaps %u, dirty %d\n",
+                    i, result, context.is_fired, context.is_nested_program, context.is_flush_pending, stat.page_swap_count, stat.is_dirty);
+            is_ok = false;
+        }
+        if (!check_contents("power_fail", &veeprom, &config, model)) {
+            is_ok = false;
+        }
+        if (!is_ok) {
+            fprintf(stderr, "power_fail: failed on program %u of %u (width %u)\n", i, flash_stat.program_count, program_width);
+        }
+        veeprom_flash_sim_deinit();
+    }
+
+    // Handler flushes immediately if instance is idle
+    veeprom_fixture_init(&veeprom, &config, FLASH_PAGE_SIZE, 1, program_width, cache);
+    memset(model, 0xFF, veeprom_get_size(&veeprom));
+    random_write(&veeprom, model);
+    veeprom_power_fail_handler(&veeprom);
+    veeprom_stat_t stat;
+    veeprom_get_stat(&veeprom, &stat);
+    if (stat.page_swap_count != 1 || stat.is_dirty) {
+        fprintf(stderr, "power_fail: idle handler: %u swaps, dirty %d (width %u)\n", stat.page_swap_count, stat.is_dirty, program_width);
+        is_ok = false;
+    }
+    if (!check_contents("power_fail", &veeprom, &config, model)) {
+        is_ok = false;
+    }
+    veeprom_flash_sim_deinit();
+    return is_ok;
+}
+
+//  ***************************************************************************
+/// @brief  Write-through: write during running swap is rejected and not counted
+/// @return true - success, false - fail
+//  ***************************************************************************
+static bool test_nested_write(void) {
+    veeprom_t veeprom;
+    veeprom_config_t config;
+    veeprom_fixture_init(&veeprom, &config, FLASH_PAGE_SIZE, 1, 2, NULL);
+    uint32_t size = veeprom_get_size(&veeprom);
+    memset(model, 0xFF, size);
+    model[0] = 0x12;
+
+    hook_context_t context = { .veeprom = &veeprom, .fire_program_count = 1 };
+    veeprom_flash_sim_reset_stat();
+    veeprom_flash_sim_set_program_hook(nested_write_hook, &context);
+    bool result = veeprom_write_8(&veeprom, 0, 0x12);
+    veeprom_flash_sim_set_program_hook(NULL, NULL);
+
+    veeprom_stat_t stat;
+    veeprom_get_stat(&veeprom, &stat);
+    bool is_ok = true;
+    if (!result || !context.is_fired || context.is_nested_write || stat.write_count != 1 || stat.page_swap_count != 1) {
+        fprintf(stderr, "nested_write: result %d, fired %d, nested write %d, %u writes, %u swaps\n",
+                result, context.is_fired, context.is_nested_write, stat.write_count, stat.page_swap_count);
+        is_ok = false;
+    }
+    if (!check_contents("nested_write", &veeprom, &config, model)) {
+        is_ok = false;
+    }
+    veeprom_flash_sim_deinit();
+    return is_ok;
+}
+
+//  ***************************************************************************
+/// @brief  Write-back with flush interval is rejected without time source
+/// @return true - success, false - fail
+//  ***************************************************************************
+static bool test_time_source(void) {
+    veeprom_t veeprom;
+    veeprom_config_t config;
+    veeprom_fixture_init(&veeprom, &config, FLASH_PAGE_SIZE, 1, 2, cache);
+    config.flush_interval_us = 1000;
+    bool result = veeprom_init(&veeprom, &config);
+    veeprom_flash_sim_deinit();
+    if (result) {
+        fprintf(stderr, "time_source: init with flush interval is success without VEEPROM_GET_TIME_US\n");
+        return false;
+    }
+    return true;
+}
+
+//  ***************************************************************************
+/// @brief  Fill VEEPROM and model by random data
+/// @param  veeprom: instance context
+/// @param  model: expected VEEPROM contents
+/// @return none
+//  ***************************************************************************
+static void random_fill(veeprom_t* veeprom, uint8_t* model) {
+    uint32_t size = veeprom_get_size(veeprom);
+    for (uint32_t i = 0; i < size; ++i) {
+        model[i] = (uint8_t)rand();
+    }
+    veeprom_write(veeprom, 0, model, size);
+}
+
+//  ***************************************************************************
+/// @brief  Write random data to random address of VEEPROM and model
+/// @param  veeprom: instance context
+/// @param  model: expected VEEPROM contents
+/// @return none
+//  ***************************************************************************
+static void random_write(veeprom_t* veeprom, uint8_t* model) {
+    uint32_t size = veeprom_get_size(veeprom);
+    uint32_t bytes_count = 1 + (uint32_t)rand() % WRITE_MAX_SIZE;
+    uint32_t addr = (uint32_t)rand() % (size - bytes_count + 1);
+    uint8_t data[WRITE_MAX_SIZE];
+    for (uint32_t i = 0; i < bytes_count; ++i) {
+        data[i] = (uint8_t)rand();
+    }
+    veeprom_write(veeprom, addr, data, bytes_count);
+    memcpy(&model[addr], data, bytes_count);
+}
+
+//  ***************************************************************************
+/// @brief  Check VEEPROM contents and checksum, then check FLASH contents
+///         by new write-through instance (as after reset)
+/// @param  test: test name for messages
+/// @param  veeprom: instance context
+/// @param  config: instance configuration
+/// @param  model: expected VEEPROM contents
+/// @return true - contents are equal to model, false - otherwise
+//  ***************************************************************************
+static bool check_contents(const char* test, const veeprom_t* veeprom, const veeprom_config_t* config, const uint8_t* model) {
+    uint32_t size = veeprom_get_size(veeprom);
+    uint8_t* data = malloc(size);
+    bool is_ok = true;
+    if (!veeprom_read(veeprom, 0, data, size) || memcmp(data, model, size) != 0) {
+        fprintf(stderr, "%s: data mismatch\n", test);
+        is_ok = false;
+    }
+
+    veeprom_t reset_veeprom;
+    veeprom_config_t reset_config = *config;
+    reset_config.cache = NULL;
+    veeprom_stat_t stat;
+    if (!veeprom_init(&reset_veeprom, &reset_config)) {
+        fprintf(stderr, "%s: init after reset failed\n", test);
+        is_ok = false;
+    }
+    else {
+        veeprom_get_stat(&reset_veeprom, &stat);
+        if (stat.stored_checksum != stat.calc_checksum) {
+            fprintf(stderr, "%s: checksum 0x%04X, expected 0x%04X\n", test, stat.stored_checksum, stat.calc_checksum);
+            is_ok = false;
+        }
+        if (!veeprom_read(&reset_veeprom, 0, data, size) || memcmp(data, model, size) != 0) {
+            fprintf(stderr, "%s: FLASH data mismatch after reset\n", test);
+            is_ok = false;
+        }
+    }
+    free(data);
+    return is_ok;
+}
+
+//  ***************************************************************************
+/// @brief  Program hook: call power fail handler (ISR) in middle of flush
+/// @param  program_count: FLASH program operations count
+/// @param  context: hook context
+/// @return none
+//  ***************************************************************************
+static void power_fail_hook(uint32_t program_count, void* context) {
+    hook_context_t* hook = (hook_context_t*)context;
+    if (program_count == hook->fire_program_count && !hook->is_fired) {
+        hook->is_fired = true;
+        veeprom_flash_sim_stat_t stat;
+        veeprom_flash_sim_get_stat(&stat);
+        veeprom_power_fail_handler(hook->veeprom);
+        veeprom_flash_sim_stat_t handler_stat;
+        veeprom_flash_sim_get_stat(&handler_stat);
+        hook->is_nested_program = handler_stat.program_count != stat.program_count || handler_stat.erase_count != stat.erase_count;
+        hook->is_flush_pending = hook->veeprom->is_flush_pending;
+    }
+}
+
+//  ***************************************************************************
+/// @brief  Program hook: write into instance in middle of write-through swap
+/// @param  program_count: FLASH program operations count
+/// @param  context: hook context
+/// @return none
+//  ***************************************************************************
+static void nested_write_hook(uint32_t program_count, void* context) {
+    hook_context_t* hook = (hook_context_t*)context;
+    if (program_count == hook->fire_program_count && !hook->is_fired) {
+        hook->is_fired = true;
+        hook->is_nested_write = veeprom_write_8(hook->veeprom, 1, 0x34);
+    }
+}
@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+"""Compare two benchmark reports and flag regressions.
+
+Usage: bench_compare.py <baseline.json> <current.json> [--threshold PERCENT]
+                        [--tolerance PATTERN=PERCENT ...] [--gate-timings]
+
+Reports are written by host benchmarks (bench_suite, cli_replay, cli_sessions_test):
+{"benchmarks": [{"name": ..., "value": ..., "unit": ..., "better": "lower" | "higher"}]}
+
+Results are split by unit:
+- deterministic (bytes, calls, ops): counted work, equal on every run of the
+  same build. Any change worse than --deterministic-threshold (default 0.01%)
+  is a regression.
+- timings (everything else): wall-clock and CPU time, noisy between runs.
+  They are reported only. With --gate-timings a timing worse than its
+  tolerance is a regression. Tolerance is --threshold (default 5%) or the
+  first matching --tolerance PATTERN=PERCENT (fnmatch pattern of name).
+
+Run bench_suite with --repeat N for both reports: each value is the median of
+N runs, which keeps timings comparable between builds.
+
+Exit code is 1 if any regression is found, otherwise 0.
+"""
+import argparse
+import fnmatch
+import json
+import sys
+
+
+DETERMINISTIC_UNITS = {"bytes", "calls", "ops"}
+
+
+def load(path):
+    with open(path) as file:
+        return {item["name"]: item for item in json.load(file)["benchmarks"]}
+
+
+def parse_tolerance(text):
+    pattern, _, percent = text.rpartition("=")
+    if not pattern:
+        raise argparse.ArgumentTypeError(f"expected PATTERN=PERCENT, got '{text}'")
+    return pattern, float(percent)
+
+
+def get_tolerance(name, tolerances, default):
+    for pattern, percent in tolerances:
+        if fnmatch.fnmatchcase(name, pattern):
+            return percent
+    return default
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare benchmark reports")
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=5.0, help="default timing tolerance in percent")
+    parser.add_argument("--tolerance", type=parse_tolerance, action="append", default=[],
+                        metavar="PATTERN=PERCENT", help="timing tolerance for results matching pattern")
+    parser.add_argument("--deterministic-threshold", type=float, default=0.01,
+                        help="tolerance for deterministic results in percent")
+    parser.add_argument("--gate-timings", action="store_true", help="timing regressions fail comparison")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+
+    regressions = 0
+    slower = 0
+    print(f"{'benchmark':<48} {'baseline':>14} {'current':>14} {'change':>9}")
+    for name, item in current.items():
+        if name not in baseline:
+            print(f"{name:<48} {'-':>14} {item['value']:>14.3f} {'new':>9}")
+            continue
+        old = baseline[name]["value"]
+        new = item["value"]
+        change = (new - old) / old * 100.0 if old else (0.0 if new == old else 100.0)
+        worse = change if item.get("better", "lower") == "lower" else -change
+        is_deterministic = item.get("unit") in DETERMINISTIC_UNITS
+        if is_deterministic:
+            tolerance = args.deterministic_threshold
+        else:
+            tolerance = get_tolerance(name, args.tolerance, args.threshold)
+        mark = ""
+        if worse > tolerance:
+            if is_deterministic or args.gate_timings:
+                mark = "  REGRESSION"
+                regressions += 1
+            else:
+                mark = "  slower"
+                slower += 1
+        print(f"{name:<48} {old:>14.3f} {new:>14.3f} {change:>+8.1f}%{mark} {item.get('unit', '')}")
+    for name in baseline:
+        if name not in current:
+            print(f"{name:<48} {baseline[name]['value']:>14.3f} {'-':>14} {'removed':>9}")
+
+    if slower:
+        print(f"{slower} timing(s) slower than tolerance (not gated, use --gate-timings)")
+    if regressions:
+        print(f"{regressions} regression(s)")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
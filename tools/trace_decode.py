@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+"""Convert trace dump ("trace dump" command output) to Chrome trace JSON.
+
+Usage: trace_decode.py [dump.txt] [-o trace.json] [--tick-us N] [--header trace.h ...]
+
+Open result in chrome://tracing or https://ui.perfetto.dev.
+
+Dump line format: IIIIIIII TTTTTTTT EE AAAA (index, timestamp, event ID, arg in hex).
+Other lines (prompt, command echo, header) are ignored, repeated events (same
+index from few dumps) are merged.
+
+Event names are taken from TRACE_EVENT_<NAME> = 0x.. enumerations in headers
+(trace.h by default, add project headers for user events). Events with names
+ending by _BEGIN/_END are converted to async duration events (begin and end
+are matched by argument, so overlapped commands of few sessions are shown
+correctly), other events are instant events. Events are grouped to tracks by name prefix
+(RING_BUFFER, VEEPROM, CLI...).
+"""
+import argparse
+import json
+import os
+import re
+import sys
+
+LINE_RE = re.compile(r"(?<![0-9A-Fa-f])([0-9A-Fa-f]{8}) ([0-9A-Fa-f]{8}) ([0-9A-Fa-f]{2}) ([0-9A-Fa-f]{4})\s*$")
+ENUM_RE = re.compile(r"TRACE_EVENT_(\w+)\s*=\s*(0x[0-9A-Fa-f]+|\d+)")
+DEFAULT_HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "trace.h")
+
+
+def load_names(headers):
+    names = {}
+    for path in headers:
+        with open(path) as file:
+            for name, value in ENUM_RE.findall(file.read()):
+                if name != "USER":  # First ID for project events, not an event
+                    names[int(value, 0)] = name
+    return names
+
+
+def parse_dump(lines):
+    events = {}
+    for line in lines:
+        match = LINE_RE.search(line)
+        if match:
+            index, timestamp, event_id, arg = (int(value, 16) for value in match.groups())
+            events[index] = (index, timestamp, event_id, arg)  # Few dumps can contain same events
+    return [events[index] for index in sorted(events)]
+
+
+def convert(events, names, tick_us):
+    tracks = {}
+    result = []
+    wraps = 0
+    last_timestamp = None
+    for index, timestamp, event_id, arg in events:
+        if last_timestamp is not None and timestamp < last_timestamp:
+            wraps += 1  # 32-bit timestamp counter overflow
+        last_timestamp = timestamp
+        ts = ((wraps << 32) + timestamp) * tick_us
+
+        name = names.get(event_id, "EVENT_0x%02X" % event_id)
+        phase = "i"
+        if name.endswith("_BEGIN"):
+            name, phase = name[:-len("_BEGIN")], "b"
+        elif name.endswith("_END"):
+            name, phase = name[:-len("_END")], "e"
+        track = name.split("_")[0]
+        if name.startswith("RING_BUFFER"):
+            track = "RING_BUFFER"
+        tid = tracks.setdefault(track, len(tracks) + 1)
+
+        event = {"name": name, "cat": track, "ph": phase, "ts": ts, "pid": 1, "tid": tid,
+                 "args": {"arg": "0x%04X" % arg, "index": index}}
+        if phase == "i":
+            event["s"] = "t"
+        else:
+            event["id"] = "0x%04X" % arg
+        result.append(event)
+
+    for track, tid in tracks.items():
+        result.append({"name": "thread_name", "ph": "M", "pid": 1, "tid": tid, "args": {"name": track}})
+    return {"traceEvents": result, "displayTimeUnit": "ns"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert trace dump to Chrome trace JSON")
+    parser.add_argument("dump", nargs="?", help="trace dump file (default: stdin)")
+    parser.add_argument("-o", "--output", help="output file (default: stdout)")
+    parser.add_argument("--tick-us", type=float, default=1.0, help="timestamp tick in microseconds")
+    parser.add_argument("--header", action="append", help="header with TRACE_EVENT_* IDs (default: trace.h)")
+    args = parser.parse_args()
+
+    names = load_names(args.header or [DEFAULT_HEADER])
+    if args.dump:
+        with open(args.dump, errors="replace") as file:
+            events = parse_dump(file)
+    else:
+        events = parse_dump(sys.stdin)
+
+    trace = convert(events, names, args.tick_us)
+    if args.output:
+        with open(args.output, "w") as file:
+            json.dump(trace, file, indent=1)
+    else:
+        json.dump(trace, sys.stdout, indent=1)
+        print()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,61 @@
+//  ***************************************************************************
+/// @file    trace.c
+/// @author  NeoProg
+//  ***************************************************************************
+#include "trace.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#if (TRACE_BUFFER_SIZE & (TRACE_BUFFER_SIZE - 1)) != 0
+#error "TRACE_BUFFER_SIZE should be power of 2"
+#endif
+typedef char trace_event_size_check[(sizeof(trace_event_t) == sizeof(uint64_t)) ? 1 : -1]; // Record is one 8 bytes word
+
+
+uint64_t trace_buffer[TRACE_BUFFER_SIZE] = {0};         // Trace ring buffer (trace_event_t records)
+volatile uint32_t trace_head = 0;                       // Logged events count (next event index)
+
+
+//  ***************************************************************************
+/// @brief  Clear trace buffer
+/// @param  none
+/// @return none
+//  ***************************************************************************
+void trace_clear(void) {
+    memset(trace_buffer, 0, sizeof(trace_buffer));
+    trace_head = 0;
+}
+
+//  ***************************************************************************
+/// @brief  Get logged events count
+/// @note   Events with indexes [head - TRACE_BUFFER_SIZE...head - 1] are available
+/// @param  none
+/// @return index of next event
+//  ***************************************************************************
+uint32_t trace_get_head(void) {
+    return trace_head;
+}
+
+//  ***************************************************************************
+/// @brief  Read event from trace buffer
+/// @param  index: event index
+/// @param  event: buffer for event
+/// @return true - success, false - event is overwritten, not logged yet or
+///         slot is reserved but record is not written yet
+//  ***************************************************************************
+bool trace_read(uint32_t index, trace_event_t* event) {
+    uint32_t head = trace_head;
+    if (index >= head || head - index > TRACE_BUFFER_SIZE) {
+        return false;
+    }
+#ifdef TRACE_LOCK_FREE
+    uint64_t record = __atomic_load_n(&trace_buffer[index & (TRACE_BUFFER_SIZE - 1)], __ATOMIC_ACQUIRE);
+#else
+    uint32_t state = CRITICAL_SECTION_ENTER();
+    uint64_t record = trace_buffer[index & (TRACE_BUFFER_SIZE - 1)];
+    CRITICAL_SECTION_EXIT(state);
+#endif
+    memcpy(event, &record, sizeof(record));
+    return event->sequence == TRACE_SEQUENCE(index); // Record of this index is written and not overwritten
+}
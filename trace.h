@@ -0,0 +1,94 @@
+//  ***************************************************************************
+/// @file    trace.h
+/// @author  NeoProg
+/// @brief   Binary event tracer
+//  ***************************************************************************
+#ifndef _TRACE_H_
+#define _TRACE_H_
+#include "critical_section.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+// Change this value for increase or decrease trace buffer size (events count, should be power of 2)
+#define TRACE_BUFFER_SIZE                   (256)
+
+// Define timestamp source in project (e.g. timer counter) for get events time
+#ifndef TRACE_GET_TIMESTAMP
+#define TRACE_GET_TIMESTAMP()               (0)
+#endif
+
+// Define TRACE_ENABLE in project for enable trace points
+#ifdef TRACE_ENABLE
+#define TRACE_EVENT(event_id, arg)          trace_event((event_id), (arg))
+#else
+#define TRACE_EVENT(event_id, arg)
+#endif
+
+// Event slot is reserved by atomic increment of trace_head and record is written by one atomic 8 bytes
+// store (trace points can be used in ISR and main loop). Targets without lock-free 8 bytes atomics
+// (Cortex-M) and other compilers reserve slot and write record in critical section
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__GCC_ATOMIC_LLONG_LOCK_FREE) && (__GCC_ATOMIC_LLONG_LOCK_FREE == 2)
+#define TRACE_LOCK_FREE
+#endif
+
+// Record sequence for event index: write lap of slot [1...255], 0 - slot is empty
+#define TRACE_SEQUENCE(index)               ((uint8_t)((index) / TRACE_BUFFER_SIZE % 255 + 1))
+
+
+typedef enum {
+    TRACE_EVENT_RING_BUFFER_PUSH        = 0x01,         // arg: buffer ID
+    TRACE_EVENT_RING_BUFFER_POP         = 0x02,         // arg: buffer ID
+    TRACE_EVENT_RING_BUFFER_OVERFLOW    = 0x03,         // arg: buffer ID
+    TRACE_EVENT_VEEPROM_ERASE_BEGIN     = 0x10,         // arg: page index
+    TRACE_EVENT_VEEPROM_ERASE_END       = 0x11,         // arg: page index
+    TRACE_EVENT_VEEPROM_PROGRAM_BEGIN   = 0x12,         // arg: virtual address
+    TRACE_EVENT_VEEPROM_PROGRAM_END     = 0x13,         // arg: virtual address
+    TRACE_EVENT_CLI_CMD_BEGIN           = 0x20,         // arg: command index in registry
+    TRACE_EVENT_CLI_CMD_END             = 0x21,         // arg: command index in registry
+    TRACE_EVENT_USER                    = 0x80          // First ID for project events
+} trace_event_id_t;
+
+typedef struct {
+    uint32_t timestamp;                                 // Event timestamp (TRACE_GET_TIMESTAMP)
+    uint16_t arg;                                       // Event argument
+    uint8_t  event_id;                                  // Event ID
+    uint8_t  sequence;                                  // TRACE_SEQUENCE() of event index (checked by trace_read)
+} trace_event_t;
+
+
+extern uint64_t trace_buffer[TRACE_BUFFER_SIZE];       // Records (trace_event_t) as 8 bytes words
+extern volatile uint32_t trace_head;
+
+extern void trace_clear(void);
+extern uint32_t trace_get_head(void);
+extern bool trace_read(uint32_t index, trace_event_t* event);
+
+//  ***************************************************************************
+/// @brief  Put event to trace buffer (oldest event is overwritten)
+/// @note   No formatting at log time: one atomic index increment and one 8 bytes store.
+///         Reserved slot keeps previous record until store, trace_read() skips it by sequence
+/// @param  event_id: event ID
+/// @param  arg: event argument
+/// @return none
+//  ***************************************************************************
+static inline void trace_event(uint8_t event_id, uint16_t arg) {
+    trace_event_t event = { .timestamp = TRACE_GET_TIMESTAMP(), .arg = arg, .event_id = event_id };
+    uint64_t record;
+#ifdef TRACE_LOCK_FREE
+    uint32_t index = __atomic_fetch_add(&trace_head, 1, __ATOMIC_RELAXED);
+    event.sequence = TRACE_SEQUENCE(index);
+    memcpy(&record, &event, sizeof(record));
+    __atomic_store_n(&trace_buffer[index & (TRACE_BUFFER_SIZE - 1)], record, __ATOMIC_RELEASE);
+#else
+    uint32_t state = CRITICAL_SECTION_ENTER();
+    uint32_t index = trace_head++;
+    event.sequence = TRACE_SEQUENCE(index);
+    memcpy(&record, &event, sizeof(record));
+    trace_buffer[index & (TRACE_BUFFER_SIZE - 1)] = record;
+    CRITICAL_SECTION_EXIT(state);
+#endif
+}
+
+
+#endif // _TRACE_H_
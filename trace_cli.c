@@ -0,0 +1,116 @@
+//  ***************************************************************************
+/// @file    trace_cli.c
+/// @author  NeoProg
+//  ***************************************************************************
+#include "trace_cli.h"
+#include "trace.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define DUMP_EVENTS_PER_CALL                (4)
+
+
+static cli_cmd_status_t cmd_dump(cli_session_t* session);
+static cli_cmd_status_t cmd_stat(cli_session_t* session);
+
+
+const char* const trace_cli_args[] = { "dump", "clear", "stat", NULL };
+
+
+//  ***************************************************************************
+/// @brief  Trace command handler
+/// @param  session: CLI session context
+/// @param  argc: arguments count
+/// @param  argv: arguments
+/// @return command status
+//  ***************************************************************************
+cli_cmd_status_t trace_cli_handler(cli_session_t* session, int32_t argc, char* argv[]) {
+    if (argc == 2) {
+        if (strcmp(argv[1], "dump") == 0) {
+            return cmd_dump(session);
+        }
+        if (strcmp(argv[1], "clear") == 0) {
+            trace_clear();
+            cli_core_send(session, "OK\r\n");
+            return CLI_CMD_DONE;
+        }
+        if (strcmp(argv[1], "stat") == 0) {
+            return cmd_stat(session);
+        }
+    }
+    cli_core_send(session, "Usage: trace dump | trace clear | trace stat\r\n");
+    return CLI_CMD_DONE;
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Stream trace buffer: trace dump
+/// @note   Events logged after dump start are not dumped. Snapshot is kept in
+///         session command data: sessions can dump at same time
+/// @param  session: CLI session context
+/// @return command status
+//  ***************************************************************************
+static cli_cmd_status_t cmd_dump(cli_session_t* session) {
+    uint32_t* dump_begin = &session->cmd_data[0];       // First dumped event index
+    uint32_t* dump_end = &session->cmd_data[1];         // Last dumped event index + 1
+
+    if (session->cmd_step == 0) { // Make snapshot
+        *dump_end = trace_get_head();
+        *dump_begin = (*dump_end > TRACE_BUFFER_SIZE) ? *dump_end - TRACE_BUFFER_SIZE : 0;
+        cli_core_send(session, "# index timestamp event arg\r\n");
+    }
+
+    for (int32_t i = 0; i < DUMP_EVENTS_PER_CALL; ++i) {
+        uint32_t index = *dump_begin + session->cmd_step;
+        if (index >= *dump_end) {
+            return CLI_CMD_DONE;
+        }
+        ++session->cmd_step;
+
+        trace_event_t event;
+        if (!trace_read(index, &event)) {
+            continue; // Event is overwritten after dump start or is not written yet
+        }
+
+        // Format line: IIIIIIII TTTTTTTT EE AAAA
+        char line[8 + 1 + 8 + 1 + 2 + 1 + 4 + 3] = {0};
+        char* p = cli_core_format_hex(line, index, 8);
+        *p++ = ' ';
+        p = cli_core_format_hex(p, event.timestamp, 8);
+        *p++ = ' ';
+        p = cli_core_format_hex(p, event.event_id, 2);
+        *p++ = ' ';
+        p = cli_core_format_hex(p, event.arg, 4);
+        strcpy(p, "\r\n");
+        cli_core_send(session, line);
+    }
+    return (*dump_begin + session->cmd_step < *dump_end) ? CLI_CMD_CONTINUE : CLI_CMD_DONE;
+}
+
+//  ***************************************************************************
+/// @brief  Print trace statistics: trace stat
+/// @param  session: CLI session context
+/// @return command status
+//  ***************************************************************************
+static cli_cmd_status_t cmd_stat(cli_session_t* session) {
+    uint32_t head = trace_get_head();
+    uint32_t buffered = (head > TRACE_BUFFER_SIZE) ? TRACE_BUFFER_SIZE : head;
+
+    char str[11] = {0};
+    cli_core_send(session, "logged: ");
+    cli_core_format_dec(str, head);
+    cli_core_send(session, str);
+    cli_core_send(session, ", buffered: ");
+    cli_core_format_dec(str, buffered);
+    cli_core_send(session, str);
+    cli_core_send(session, ", overwritten: ");
+    cli_core_format_dec(str, head - buffered);
+    cli_core_send(session, str);
+    cli_core_send(session, "\r\n");
+    return CLI_CMD_DONE;
+}
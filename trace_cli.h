@@ -0,0 +1,29 @@
+//  ***************************************************************************
+/// @file    trace_cli.h
+/// @author  NeoProg
+/// @brief   Trace CLI commands
+//  ***************************************************************************
+#ifndef _TRACE_CLI_H_
+#define _TRACE_CLI_H_
+#include "cli_core.h"
+
+// Command description for command registry
+#define TRACE_CLI_CMD                       { .name = "trace", .args = trace_cli_args, .handler = trace_cli_handler }
+
+
+extern const char* const trace_cli_args[];
+
+//  ***************************************************************************
+/// @brief  Trace command handler
+/// @note   trace dump  - stream trace buffer: "<index> <timestamp> <event id> <arg>" lines (HEX)
+///         trace clear - clear trace buffer
+///         trace stat  - print logged, buffered and overwritten events count
+/// @param  session: CLI session context
+/// @param  argc: arguments count
+/// @param  argv: arguments
+/// @return command status
+//  ***************************************************************************
+extern cli_cmd_status_t trace_cli_handler(cli_session_t* session, int32_t argc, char* argv[]);
+
+
+#endif // _TRACE_CLI_H_
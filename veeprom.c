@@ -3,346 +3,531 @@
 /// @author  NeoProg
 //  ***************************************************************************
 #include "veeprom.h"
-#include "project_base.h"
-#define FLASH_PAGE_SIZE                     (1024)
-#define VEEPROM_SERVICE_HEADER_SIZE         (10)
-#define VEEPROM_PAGE_1_ADDR                 (0x08003800)
-#define VEEPROM_PAGE_2_ADDR                 (0x08003C00)
-#define VEEPROM_PAGE_SIZE                   (FLASH_PAGE_SIZE - VEEPROM_SERVICE_HEADER_SIZE)
+#include "veeprom_flash.h"
+#include "trace.h"
+#include "critical_section.h"
+#include <string.h>
+#define MAX_PROGRAM_WIDTH                   (8)
 
-#define PAGE_CHECKSUM_OFFSET                (VEEPROM_PAGE_SIZE)
+#define PAGE_CHECKSUM_OFFSET(v)             ((v)->size)
+#define PAGE_STATE_OFFSET(v, unit)          ((v)->size + (v)->config.program_width * (1 + (unit)))
+#define PAGE_STATE_UNITS_COUNT              (4)
+#define PAGE_STATE_INVALID                  (VEEPROM_PAGE_STATE_INVALID)
+#define PAGE_STATE_COPY                     (VEEPROM_PAGE_STATE_COPY)
+#define PAGE_STATE_VALID                    (VEEPROM_PAGE_STATE_VALID)
+#define PAGE_STATE_WRITE                    (VEEPROM_PAGE_STATE_WRITE)
+#define PAGE_STATE_ERASED                   (VEEPROM_PAGE_STATE_ERASED)
 
-#define PAGE_STATE_OFFSET                   (VEEPROM_PAGE_SIZE + 2)
-#define PAGE_STATE_INVALID                  ((uint64_t)(0x0000000000000000))
-#define PAGE_STATE_COPY                     ((uint64_t)(0x000000000000FFFF))
-#define PAGE_STATE_VALID                    ((uint64_t)(0x00000000FFFFFFFF))
-#define PAGE_STATE_WRITE                    ((uint64_t)(0x0000FFFFFFFFFFFF))
-#define PAGE_STATE_ERASED                   ((uint64_t)(0xFFFFFFFFFFFFFFFF))
+#define STATE_UNIT_ERASED                   (0xFFFF)
+#define STATE_UNIT_PROGRAMMED               (0x0000)
+#define STATE_UNIT_CORRUPTED                (0x5A5A)  // Partially programmed unit (e.g. power loss)
 
+#ifndef VEEPROM_GET_TIME_US
+#define VEEPROM_GET_TIME_US()               (0)     // Define timer function in project for measure write latency and flush by interval
+#define VEEPROM_NO_TIME_SOURCE
+#endif
 
-static uint32_t active_page_addr = 0;
-static uint32_t inactive_page_addr = 0;
 
+static bool flash_operation_begin(veeprom_t* veeprom, bool is_flush);
+static void flash_operation_end(veeprom_t* veeprom);
+static bool flash_page_swap(veeprom_t* veeprom, uint32_t veeprom_addr, const uint8_t* data, uint32_t bytes_count);
+static bool flash_page_copy(veeprom_t* veeprom, uint32_t veeprom_addr, const uint8_t* data, uint32_t bytes_count);
+static bool flash_page_erase(veeprom_t* veeprom, uint32_t flash_addr);
 
-static bool flash_lock();
-static bool flash_unlock();
-static bool flash_wait_and_check();
-static bool flash_page_erase(uint32_t flash_addr);
+static uint64_t flash_page_get_state(const veeprom_t* veeprom, uint32_t flash_addr);
+static bool     flash_page_set_state(const veeprom_t* veeprom, uint32_t flash_addr, uint64_t state);
+static uint16_t flash_unit_get_state(const veeprom_t* veeprom, uint32_t flash_addr);
 
-static uint64_t flash_page_get_state(uint32_t flash_addr);
-static bool     flash_page_set_state(uint32_t flash_addr, uint64_t state);
-
-static uint16_t flash_page_calc_checksum(uint32_t flash_addr);
-static uint16_t flash_page_read_checksum(uint32_t flash_addr);
-static bool     flash_page_write_checksum(uint32_t flash_addr, uint16_t checksum);
-
-static uint8_t  flash_read_8(uint32_t flash_addr);
-static uint16_t flash_read_16(uint32_t flash_addr);
-static uint32_t flash_read_32(uint32_t flash_addr);
-static bool     flash_write_16(uint32_t flash_addr, uint16_t value);
+static uint16_t flash_page_calc_checksum(const veeprom_t* veeprom, uint32_t flash_addr);
+static uint16_t flash_page_read_checksum(const veeprom_t* veeprom, uint32_t flash_addr);
+static bool     flash_page_write_checksum(const veeprom_t* veeprom, uint32_t flash_addr, uint16_t checksum);
 
 
 
 //  ***************************************************************************
 /// @brief  VEEPROM driver initializetion
+/// @param  [out] veeprom: instance context
+/// @param  [in] config: instance configuration (copied into context)
 /// @return true - init success, false - fail
 //  ***************************************************************************
-bool veeprom_init() {
+bool veeprom_init(veeprom_t* veeprom, const veeprom_config_t* config) {
+    memset(veeprom, 0, sizeof(veeprom_t));
+
+    // Check configuration
+    uint32_t width = config->program_width;
+    if ((width != 2 && width != 4 && width != 8) || !veeprom_flash_is_width_supported(width) ||
+        config->page_count == 0 || config->page_size % width != 0 ||
+        config->page_size * config->page_count <= VEEPROM_SERVICE_HEADER_SIZE(width)) {
+        return false;
+    }
+#ifdef VEEPROM_NO_TIME_SOURCE
+    if (config->cache != NULL && config->flush_interval_us != 0) {
+        return false; // Flush interval can't be measured: dirty RAM image would never be flushed by veeprom_process()
+    }
+#endif
+    veeprom->config = *config;
+    veeprom->size = VEEPROM_SIZE(config->page_size, config->page_count, width);
+
     // Search active page
-    uint64_t page1_state = flash_page_get_state(VEEPROM_PAGE_1_ADDR);
-    uint64_t page2_state = flash_page_get_state(VEEPROM_PAGE_2_ADDR);
+    uint32_t page1_addr = config->page_addr[0];
+    uint32_t page2_addr = config->page_addr[1];
+    uint64_t page1_state = flash_page_get_state(veeprom, page1_addr);
+    uint64_t page2_state = flash_page_get_state(veeprom, page2_addr);
     if (page1_state == PAGE_STATE_VALID) {
-        active_page_addr = VEEPROM_PAGE_1_ADDR;
-        inactive_page_addr = VEEPROM_PAGE_2_ADDR;
-    } 
+        veeprom->active_page_addr = page1_addr;
+        veeprom->inactive_page_addr = page2_addr;
+    }
     else if (page2_state == PAGE_STATE_VALID) {
-        active_page_addr = VEEPROM_PAGE_2_ADDR;
-        inactive_page_addr = VEEPROM_PAGE_1_ADDR;
-    } 
+        veeprom->active_page_addr = page2_addr;
+        veeprom->inactive_page_addr = page1_addr;
+    }
     else if (page1_state == PAGE_STATE_COPY) {
-        active_page_addr = VEEPROM_PAGE_1_ADDR;
-        inactive_page_addr = VEEPROM_PAGE_2_ADDR;
+        veeprom->active_page_addr = page1_addr;
+        veeprom->inactive_page_addr = page2_addr;
     }
     else if (page2_state == PAGE_STATE_COPY) {
-        active_page_addr = VEEPROM_PAGE_2_ADDR;
-        inactive_page_addr = VEEPROM_PAGE_1_ADDR;
+        veeprom->active_page_addr = page2_addr;
+        veeprom->inactive_page_addr = page1_addr;
     }
     else {
-        if (!flash_page_erase(VEEPROM_PAGE_1_ADDR)) {
+        if (!flash_page_erase(veeprom, page1_addr)) {
             return false;
         }
-        active_page_addr = VEEPROM_PAGE_1_ADDR;
-        inactive_page_addr = VEEPROM_PAGE_2_ADDR;
+        veeprom->active_page_addr = page1_addr;
+        veeprom->inactive_page_addr = page2_addr;
+        if (config->cache != NULL) {
+            memset(config->cache, 0xFF, veeprom->size);
+        }
         return true;
     }
-    
+
+    // Load RAM image
+    if (config->cache != NULL) {
+        for (uint32_t i = 0; i < veeprom->size; ++i) {
+            config->cache[i] = veeprom_flash_read_8(veeprom->active_page_addr + i);
+        }
+    }
+
     // Check checksum
-    return flash_page_read_checksum(active_page_addr) != flash_page_calc_checksum(active_page_addr);
+    return flash_page_read_checksum(veeprom, veeprom->active_page_addr) == flash_page_calc_checksum(veeprom, veeprom->active_page_addr);
 }
 
 //  ***************************************************************************
 /// @brief  Mass erase VEEPROM
+/// @param  [in] veeprom: instance context
 /// @return true - init success, false - fail
 //  ***************************************************************************
-bool veeprom_mass_erase() {
-    return flash_page_erase(VEEPROM_PAGE_1_ADDR) && flash_page_erase(VEEPROM_PAGE_2_ADDR);
+bool veeprom_mass_erase(veeprom_t* veeprom) {
+    if (!flash_operation_begin(veeprom, false)) {
+        return false;
+    }
+    if (veeprom->config.cache != NULL) {
+        memset(veeprom->config.cache, 0xFF, veeprom->size);
+        veeprom->is_cache_dirty = false;
+    }
+    bool result = flash_page_erase(veeprom, veeprom->config.page_addr[0]) && flash_page_erase(veeprom, veeprom->config.page_addr[1]);
+    flash_operation_end(veeprom);
+    return result;
+}
+
+//  ***************************************************************************
+/// @brief  Get VEEPROM size
+/// @param  [in] veeprom: instance context
+/// @return VEEPROM size in bytes
+//  ***************************************************************************
+uint32_t veeprom_get_size(const veeprom_t* veeprom) {
+    return veeprom->size;
+}
+
+//  ***************************************************************************
+/// @brief  Get VEEPROM statistics
+/// @param  [in] veeprom: instance context
+/// @param  [out] stat: pointer to buffer for statistics
+//  ***************************************************************************
+void veeprom_get_stat(const veeprom_t* veeprom, veeprom_stat_t* stat) {
+    uint32_t active_page_addr = veeprom->active_page_addr;
+    stat->active_page_addr = active_page_addr;
+    for (uint32_t i = 0; i < VEEPROM_PAGES_COUNT; ++i) {
+        stat->page_addr[i] = veeprom->config.page_addr[i];
+        stat->page_state[i] = active_page_addr ? flash_page_get_state(veeprom, stat->page_addr[i]) : PAGE_STATE_INVALID;
+        stat->page_erase_count[i] = veeprom->page_erase_count[i];
+    }
+    stat->size = veeprom->size;
+    stat->program_width = veeprom->config.program_width;
+    stat->stored_checksum = active_page_addr ? flash_page_read_checksum(veeprom, active_page_addr) : 0;
+    stat->calc_checksum = active_page_addr ? flash_page_calc_checksum(veeprom, active_page_addr) : 0;
+    stat->write_count = veeprom->write_count;
+    stat->page_swap_count = veeprom->page_swap_count;
+    stat->last_write_time_us = veeprom->last_write_time_us;
+    stat->is_dirty = veeprom->is_cache_dirty;
 }
 
 //  ***************************************************************************
 /// @brief  Read data from VEEPROM
+/// @param  [in] veeprom: instance context
 /// @param  [in] veeprom_addr: virtual address [0x0000...size-1]
 /// @param  [out] buffer: pointer to buffer for data
 /// @param  [in] bytes_count: bytes count for read
 /// @return true - init success, false - fail
 //  ***************************************************************************
-bool veeprom_read(uint32_t veeprom_addr, uint8_t* buffer, uint32_t bytes_count) {
-    if (veeprom_addr + bytes_count >= VEEPROM_PAGE_SIZE || !active_page_addr) {
+bool veeprom_read(const veeprom_t* veeprom, uint32_t veeprom_addr, uint8_t* buffer, uint32_t bytes_count) {
+    if (veeprom_addr > veeprom->size || bytes_count > veeprom->size - veeprom_addr || !veeprom->active_page_addr) {
         return false;
     }
+    if (veeprom->config.cache != NULL) {
+        memcpy(buffer, &veeprom->config.cache[veeprom_addr], bytes_count);
+        return true;
+    }
     while (bytes_count) {
-        *buffer = flash_read_8(active_page_addr + veeprom_addr);
+        *buffer = veeprom_flash_read_8(veeprom->active_page_addr + veeprom_addr);
+        ++veeprom_addr;
         ++buffer;
         --bytes_count;
     }
     return true;
 }
-uint8_t veeprom_read_8(uint32_t veeprom_addr) {
+uint8_t veeprom_read_8(const veeprom_t* veeprom, uint32_t veeprom_addr) {
     uint8_t data = 0;
-    veeprom_read(veeprom_addr, &data, sizeof(data));
+    veeprom_read(veeprom, veeprom_addr, &data, sizeof(data));
     return data;
 }
-uint16_t veeprom_read_16(uint32_t veeprom_addr) {
+uint16_t veeprom_read_16(const veeprom_t* veeprom, uint32_t veeprom_addr) {
     uint16_t data = 0;
-    veeprom_read(veeprom_addr, (uint8_t*)&data, sizeof(data));
+    veeprom_read(veeprom, veeprom_addr, (uint8_t*)&data, sizeof(data));
     return data;
 }
-uint32_t veeprom_read_32(uint32_t veeprom_addr) {
+uint32_t veeprom_read_32(const veeprom_t* veeprom, uint32_t veeprom_addr) {
     uint32_t data = 0;
-    veeprom_read(veeprom_addr, (uint8_t*)&data, sizeof(data));
+    veeprom_read(veeprom, veeprom_addr, (uint8_t*)&data, sizeof(data));
     return data;
 }
 
 //  ***************************************************************************
 /// @brief  Write data to VEEPROM
+/// @note   In write-back mode data is written into RAM image only. RAM image
+///         is updated in critical section: power fail flush can't see
+///         partially copied data
+/// @param  [in] veeprom: instance context
 /// @param  [in] veeprom_addr: virtual address [0x0000...size-1]
 /// @param  [out] data: pointer to data for write
 /// @param  [in] bytes_count: bytes count for write
 /// @return true - init success, false - fail
 //  ***************************************************************************
-bool veeprom_write(uint32_t veeprom_addr, uint8_t* data, uint32_t bytes_count) {
+bool veeprom_write(veeprom_t* veeprom, uint32_t veeprom_addr, const uint8_t* data, uint32_t bytes_count) {
+    if (veeprom_addr > veeprom->size || bytes_count > veeprom->size - veeprom_addr || !veeprom->active_page_addr) {
+        return false;
+    }
+
+    uint8_t* cache = veeprom->config.cache;
+    if (cache == NULL) {
+        if (!flash_operation_begin(veeprom, false)) {
+            return false;
+        }
+        bool result = flash_page_swap(veeprom, veeprom_addr, data, bytes_count);
+        flash_operation_end(veeprom);
+        if (result) {
+            ++veeprom->write_count;
+        }
+        return result;
+    }
+    if (memcmp(&cache[veeprom_addr], data, bytes_count) != 0) {
+        uint32_t state = CRITICAL_SECTION_ENTER();
+        memcpy(&cache[veeprom_addr], data, bytes_count);
+        if (!veeprom->is_cache_dirty) {
+            veeprom->is_cache_dirty = true;
+            veeprom->cache_dirty_time_us = VEEPROM_GET_TIME_US();
+        }
+        CRITICAL_SECTION_EXIT(state);
+    }
+    ++veeprom->write_count;
+    return true;
+}
+bool veeprom_write_8(veeprom_t* veeprom, uint32_t veeprom_addr, uint8_t value) {
+    return veeprom_write(veeprom, veeprom_addr, &value, 1);
+}
+bool veeprom_write_16(veeprom_t* veeprom, uint32_t veeprom_addr, uint16_t value) {
+    return veeprom_write(veeprom, veeprom_addr, (uint8_t*)&value, 2);
+}
+bool veeprom_write_32(veeprom_t* veeprom, uint32_t veeprom_addr, uint32_t value) {
+    return veeprom_write(veeprom, veeprom_addr, (uint8_t*)&value, 4);
+}
+
+//  ***************************************************************************
+/// @brief  Write RAM image to FLASH (one page swap for all pending writes)
+/// @note   Does nothing in write-through mode or if RAM image is clean.
+///         Flush from ISR during other FLASH operation is deferred
+/// @param  [in] veeprom: instance context
+/// @return true - success, false - fail or deferred (RAM image stays dirty)
+//  ***************************************************************************
+bool veeprom_flush(veeprom_t* veeprom) {
+    if (veeprom->config.cache == NULL || !veeprom->is_cache_dirty) {
+        return true;
+    }
+    if (!flash_operation_begin(veeprom, true)) {
+        return false;
+    }
+    bool result = flash_page_swap(veeprom, 0, veeprom->config.cache, veeprom->size);
+    if (result) {
+        veeprom->is_cache_dirty = false;
+    }
+    flash_operation_end(veeprom);
+    return result;
+}
+
+//  ***************************************************************************
+/// @brief  VEEPROM process. Flush RAM image if it is dirty longer than
+///         flush interval. Call it from main loop
+/// @param  [in] veeprom: instance context
+//  ***************************************************************************
+void veeprom_process(veeprom_t* veeprom) {
+    if (veeprom->is_cache_dirty && VEEPROM_GET_TIME_US() - veeprom->cache_dirty_time_us >= veeprom->config.flush_interval_us) {
+        veeprom_flush(veeprom);
+        veeprom->cache_dirty_time_us = VEEPROM_GET_TIME_US(); // Retry after interval if flush is failed
+    }
+}
+
+//  ***************************************************************************
+/// @brief  Power fail warning handler (e.g. PVD or brownout interrupt)
+/// @note   Writes pending data immediately. Supply should hold for one page
+///         erase and program. If handler interrupts page swap, flush is
+///         deferred: running swap is completed by main loop and RAM image
+///         is flushed right after it (supply should hold for two swaps)
+/// @param  [in] veeprom: instance context
+//  ***************************************************************************
+void veeprom_power_fail_handler(veeprom_t* veeprom) {
+    veeprom_flush(veeprom);
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Begin FLASH operation (page swap or erase)
+/// @note   Operations are not nested: power fail ISR can interrupt main loop
+///         operation, in this case ISR flush is marked as pending
+/// @param  [in] veeprom: instance context
+/// @param  [in] is_flush: true - request is flush (defer it if instance is busy)
+/// @return true - operation can be started, false - instance is busy
+//  ***************************************************************************
+static bool flash_operation_begin(veeprom_t* veeprom, bool is_flush) {
+    uint32_t state = CRITICAL_SECTION_ENTER();
+    bool is_started = !veeprom->is_busy;
+    if (is_started) {
+        veeprom->is_busy = true;
+    }
+    else if (is_flush) {
+        veeprom->is_flush_pending = true;
+    }
+    CRITICAL_SECTION_EXIT(state);
+    return is_started;
+}
+
+//  ***************************************************************************
+/// @brief  End FLASH operation and do flush deferred during it
+/// @param  [in] veeprom: instance context
+//  ***************************************************************************
+static void flash_operation_end(veeprom_t* veeprom) {
+    uint32_t state = CRITICAL_SECTION_ENTER();
+    bool is_flush_pending = veeprom->is_flush_pending;
+    veeprom->is_flush_pending = false;
+    veeprom->is_busy = false;
+    CRITICAL_SECTION_EXIT(state);
+    if (is_flush_pending) {
+        veeprom_flush(veeprom);
+    }
+}
+
+//  ***************************************************************************
+/// @brief  Page swap with statistics and trace (END event is logged on fail too)
+/// @param  [in] veeprom: instance context
+/// @param  [in] veeprom_addr: virtual address of changed data
+/// @param  [in] data: pointer to changed data
+/// @param  [in] bytes_count: changed data size
+/// @return true - success, false - fail
+//  ***************************************************************************
+static bool flash_page_swap(veeprom_t* veeprom, uint32_t veeprom_addr, const uint8_t* data, uint32_t bytes_count) {
+    uint32_t begin_time_us = VEEPROM_GET_TIME_US();
+    ++veeprom->page_swap_count;
+    TRACE_EVENT(TRACE_EVENT_VEEPROM_PROGRAM_BEGIN, veeprom_addr);
+    bool result = flash_page_copy(veeprom, veeprom_addr, data, bytes_count);
+    if (result) {
+        veeprom->last_write_time_us = VEEPROM_GET_TIME_US() - begin_time_us;
+    }
+    TRACE_EVENT(TRACE_EVENT_VEEPROM_PROGRAM_END, veeprom_addr);
+    return result;
+}
+
+//  ***************************************************************************
+/// @brief  Copy active page into inactive with change data and swap pages
+/// @param  [in] veeprom: instance context
+/// @param  [in] veeprom_addr: virtual address of changed data
+/// @param  [in] data: pointer to changed data
+/// @param  [in] bytes_count: changed data size
+/// @return true - success, false - fail
+//  ***************************************************************************
+static bool flash_page_copy(veeprom_t* veeprom, uint32_t veeprom_addr, const uint8_t* data, uint32_t bytes_count) {
+    uint32_t active_page_addr = veeprom->active_page_addr;
+    uint32_t inactive_page_addr = veeprom->inactive_page_addr;
+    uint32_t width = veeprom->config.program_width;
+
     // Erase inactive page (set ERASED state)
-    if (!flash_page_erase(inactive_page_addr)) {
+    if (!flash_page_erase(veeprom, inactive_page_addr)) {
         return false;
     }
-    
-    flash_unlock();
-    
+
+    veeprom_flash_unlock();
+
     // Set COPY state for active page
-    if (!flash_page_set_state(active_page_addr, PAGE_STATE_COPY)) {
-        flash_lock();
+    if (!flash_page_set_state(veeprom, active_page_addr, PAGE_STATE_COPY)) {
+        veeprom_flash_lock();
         return false;
     }
-    
+
     // Set WRITE state for inactive page
-    if (!flash_page_set_state(inactive_page_addr, PAGE_STATE_WRITE)) {
-        flash_lock();
+    if (!flash_page_set_state(veeprom, inactive_page_addr, PAGE_STATE_WRITE)) {
+        veeprom_flash_lock();
         return false;
     }
-    
-    // Copy data from active page into inactive with change data
-    for (uint32_t offset = 0; offset < VEEPROM_PAGE_SIZE; /* NONE */) {
-        uint8_t byte[2] = {0};
-        for (uint32_t i = 0; i < 2; ++i) {
+
+    // Copy data from active page into inactive with change data. Inactive page is erased,
+    // so units with all 0xFF bytes are skipped
+    for (uint32_t offset = 0; offset < veeprom->size; /* NONE */) {
+        uint8_t unit[MAX_PROGRAM_WIDTH] = {0};
+        bool is_erased = true;
+        for (uint32_t i = 0; i < width; ++i) {
             if (offset >= veeprom_addr && offset < veeprom_addr + bytes_count) {
-                byte[i] = *data;
+                unit[i] = *data;
                 ++data;
             } else {
-                byte[i] = flash_read_8(active_page_addr + offset);
+                unit[i] = veeprom_flash_read_8(active_page_addr + offset);
             }
+            is_erased = is_erased && unit[i] == 0xFF;
             ++offset;
         }
-        uint16_t word = ((byte[0] << 8) & 0xFF00) | byte[1];
-        if (word != flash_read_16(inactive_page_addr + offset - 2)) {
+        if (!is_erased) {
             // Write data
-            if (!flash_write_16(inactive_page_addr + offset - 2, word)) {
-                flash_lock();
+            if (!veeprom_flash_program(inactive_page_addr + offset - width, unit, width)) {
+                veeprom_flash_lock();
                 return false;
             }
         }
     }
-    
+
     // Calc checksum for inactive page
-    uint16_t checksum = flash_page_calc_checksum(inactive_page_addr);
-    if (!flash_page_write_checksum(inactive_page_addr, checksum)) {
-        flash_lock();
+    uint16_t checksum = flash_page_calc_checksum(veeprom, inactive_page_addr);
+    if (!flash_page_write_checksum(veeprom, inactive_page_addr, checksum)) {
+        veeprom_flash_lock();
         return false;
     }
-    
+
     // Set VALID state for inactive page
-    if (!flash_page_set_state(inactive_page_addr, PAGE_STATE_VALID)) {
-        flash_lock();
+    if (!flash_page_set_state(veeprom, inactive_page_addr, PAGE_STATE_VALID)) {
+        veeprom_flash_lock();
         return false;
     }
-    
+
     // Set INVALID state for active page
-    if (!flash_page_set_state(active_page_addr, PAGE_STATE_INVALID)) {
-        flash_lock();
+    if (!flash_page_set_state(veeprom, active_page_addr, PAGE_STATE_INVALID)) {
+        veeprom_flash_lock();
         return false;
     }
-    
-    // Swap pages
-    uint32_t tmp = inactive_page_addr;
-    inactive_page_addr = active_page_addr;
-    active_page_addr = tmp;
-    
-    flash_lock();
-    return true;
-}
-bool veeprom_write_8(uint32_t veeprom_addr, uint8_t value) {
-    return veeprom_write(veeprom_addr, &value, 1);
-}
-bool veeprom_write_16(uint32_t veeprom_addr, uint16_t value) {
-    return veeprom_write(veeprom_addr, (uint8_t*)&value, 2);
-}
-bool veeprom_write_32(uint32_t veeprom_addr, uint32_t value) {
-    return veeprom_write(veeprom_addr, (uint8_t*)&value, 4);
-}
-
-
-
-
 
-//  ***************************************************************************
-/// @brief  Lock/unlock FLASH
-/// @return true - init success, false - fail
-//  ***************************************************************************
-static bool flash_lock() {
-    FLASH->CR |= FLASH_CR_LOCK;
-    return (FLASH->CR & FLASH_CR_LOCK) == FLASH_CR_LOCK;
-}
-static bool flash_unlock() {
-    if (FLASH->CR & FLASH_CR_LOCK) {
-        FLASH->KEYR = 0x45670123;
-        FLASH->KEYR = 0xCDEF89AB;
-    }
-    return (FLASH->CR & FLASH_CR_LOCK) != FLASH_CR_LOCK;
-}
+    // Swap pages
+    veeprom->inactive_page_addr = active_page_addr;
+    veeprom->active_page_addr = inactive_page_addr;
 
-//  ***************************************************************************
-/// @brief  Wait FLASH operation complete
-/// @return true - operation comleted, false - operation comleted with error
-//  ***************************************************************************
-static bool flash_wait_and_check() {
-    while (FLASH->SR & FLASH_SR_BSY);
-    if (FLASH->SR & (FLASH_SR_PGERR | FLASH_SR_WRPRTERR)) {
-        FLASH->SR |= FLASH_SR_PGERR | FLASH_SR_WRPRTERR | FLASH_SR_EOP;
-        return false;
-    }
-    FLASH->SR |= FLASH_SR_PGERR | FLASH_SR_WRPRTERR | FLASH_SR_EOP;
+    veeprom_flash_lock();
     return true;
 }
 
 //  ***************************************************************************
-/// @brief  Erase FLASH page
+/// @brief  Erase VEEPROM page (all FLASH pages of it)
+/// @param  [in] veeprom: instance context
 /// @param  [in] flash_addr: page address for erase
 /// @return true - success, false - fail
 //  ***************************************************************************
-static bool flash_page_erase(uint32_t flash_addr) {
-    flash_unlock();
-    
-    FLASH->CR |= FLASH_CR_PER;
-    FLASH->AR = flash_addr;
-    FLASH->CR |= FLASH_CR_STRT;
-    bool result = flash_wait_and_check();
-    FLASH->CR &= ~FLASH_CR_PER;
-    
-    flash_lock();
+static bool flash_page_erase(veeprom_t* veeprom, uint32_t flash_addr) {
+    uint32_t page_index = (flash_addr == veeprom->config.page_addr[0]) ? 0 : 1;
+    ++veeprom->page_erase_count[page_index];
+    TRACE_EVENT(TRACE_EVENT_VEEPROM_ERASE_BEGIN, page_index);
+    bool result = true;
+    for (uint32_t i = 0; i < veeprom->config.page_count && result; ++i) {
+        result = veeprom_flash_page_erase(flash_addr + i * veeprom->config.page_size);
+    }
+    TRACE_EVENT(TRACE_EVENT_VEEPROM_ERASE_END, page_index);
     return result;
 }
 
 //  ***************************************************************************
 /// @brief  Get/set FLASH page state
+/// @note   Each state step uses own program unit. Programmed units are never
+///         programmed again (required for FLASH with ECC)
+/// @param  [in] veeprom: instance context
 /// @param  [in] flash_addr: page address
 /// @param  [in] state: new page state (for flash_page_set_state)
 /// @return true - success, false - fail
 //  ***************************************************************************
-static uint64_t flash_page_get_state(uint32_t flash_addr) {
+static uint64_t flash_page_get_state(const veeprom_t* veeprom, uint32_t flash_addr) {
     uint64_t state = 0;
-    for (uint8_t i = 0; i < 4; ++i) {
-        state = (state << 16) | flash_read_16(flash_addr + PAGE_STATE_OFFSET + i * 2);
+    for (uint32_t i = 0; i < PAGE_STATE_UNITS_COUNT; ++i) {
+        state = (state << 16) | flash_unit_get_state(veeprom, flash_addr + PAGE_STATE_OFFSET(veeprom, i));
     }
     return state;
 }
-static bool flash_page_set_state(uint32_t flash_addr, uint64_t state) {
-    uint64_t mask = 0xFFFF000000000000;
-    for (uint8_t i = 0; i < 4; ++i) {
-        if (state & mask) {
-            if (flash_read_16(flash_addr + PAGE_STATE_OFFSET + i * 2) != 0xFFFF) {
-                return false;
-            }
+static bool flash_page_set_state(const veeprom_t* veeprom, uint32_t flash_addr, uint64_t state) {
+    static const uint8_t programmed_unit[MAX_PROGRAM_WIDTH] = {0};
+    for (uint32_t i = 0; i < PAGE_STATE_UNITS_COUNT; ++i) {
+        uint32_t unit_addr = flash_addr + PAGE_STATE_OFFSET(veeprom, i);
+        uint16_t unit_state = flash_unit_get_state(veeprom, unit_addr);
+        uint16_t new_unit_state = (uint16_t)(state >> (16 * (PAGE_STATE_UNITS_COUNT - 1 - i)));
+        if (unit_state == new_unit_state) {
             continue;
         }
-        if (!flash_write_16(flash_addr + PAGE_STATE_OFFSET + i * 2, 0x0000)) {
+        if (unit_state != STATE_UNIT_ERASED || new_unit_state != STATE_UNIT_PROGRAMMED) {
+            return false; // State can't go back
+        }
+        if (!veeprom_flash_program(unit_addr, programmed_unit, veeprom->config.program_width)) {
             return false;
         }
-        mask >>= 16;
     }
     return true;
 }
+static uint16_t flash_unit_get_state(const veeprom_t* veeprom, uint32_t flash_addr) {
+    bool is_erased = true;
+    bool is_programmed = true;
+    for (uint32_t i = 0; i < veeprom->config.program_width; ++i) {
+        uint8_t value = veeprom_flash_read_8(flash_addr + i);
+        is_erased = is_erased && value == 0xFF;
+        is_programmed = is_programmed && value == 0x00;
+    }
+    if (is_erased) {
+        return STATE_UNIT_ERASED;
+    }
+    return is_programmed ? STATE_UNIT_PROGRAMMED : STATE_UNIT_CORRUPTED;
+}
 
 //  ***************************************************************************
 /// @brief  Calc/read/write checksum
+/// @param  [in] veeprom: instance context
 /// @param  [in] flash_addr: page address
 /// @param  [in] checksum: new page checksum (for flash_page_write_checksum)
 /// @return true - success, false - fail
 //  ***************************************************************************
-static uint16_t flash_page_calc_checksum(uint32_t flash_addr) {
-    uint32_t bytes_count = VEEPROM_PAGE_SIZE;
+static uint16_t flash_page_calc_checksum(const veeprom_t* veeprom, uint32_t flash_addr) {
+    uint32_t bytes_count = veeprom->size;
     uint16_t checksum = 0;
     while (bytes_count) {
-        checksum += flash_read_8(flash_addr);
+        checksum += veeprom_flash_read_8(flash_addr);
         ++flash_addr;
         --bytes_count;
     }
     return checksum;
 }
-static uint16_t flash_page_read_checksum(uint32_t flash_addr) {
-    return flash_read_16(flash_addr + PAGE_CHECKSUM_OFFSET);
+static uint16_t flash_page_read_checksum(const veeprom_t* veeprom, uint32_t flash_addr) {
+    return veeprom_flash_read_16(flash_addr + PAGE_CHECKSUM_OFFSET(veeprom));
 }
-static bool flash_page_write_checksum(uint32_t flash_addr, uint16_t checksum) {
-    return flash_write_16(flash_addr + PAGE_CHECKSUM_OFFSET, checksum);
-}
-
-//  ***************************************************************************
-/// @brief  Read data from FLASH in BE format
-/// @param  [in] flash_addr: page address
-/// @param  [in] state: new page state (for flash_page_set_state)
-/// @return cell value
-//  ***************************************************************************
-static uint8_t flash_read_8(uint32_t flash_addr) {
-    return *((uint8_t*)flash_addr);
-}
-static uint16_t flash_read_16(uint32_t flash_addr) {
-    return __REV16(*((uint16_t*)flash_addr));
-}
-static uint32_t flash_read_32(uint32_t flash_addr) {
-    return __REV(*((uint32_t*)flash_addr));
-}
-
-//  ***************************************************************************
-/// @brief  Write word to FLASH in LE format
-/// @param  [in] flash_addr: page address
-/// @param  [in] value: new cell value
-/// @return true - success, false - fail
-//  ***************************************************************************
-static bool flash_write_16(uint32_t flash_addr, uint16_t value) {
-    FLASH->CR |= FLASH_CR_PG;
-    *((uint16_t*)flash_addr) = __REV16(value);
-    bool result = flash_wait_and_check();
-    FLASH->CR &= ~FLASH_CR_PG;
-    
-    if (flash_read_16(flash_addr) != value) {
-        return false;
-    }
-    return result;
+static bool flash_page_write_checksum(const veeprom_t* veeprom, uint32_t flash_addr, uint16_t checksum) {
+    uint8_t unit[MAX_PROGRAM_WIDTH] = { (uint8_t)(checksum >> 8), (uint8_t)checksum, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+    return veeprom_flash_program(flash_addr + PAGE_CHECKSUM_OFFSET(veeprom), unit, veeprom->config.program_width);
 }
@@ -8,42 +8,145 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#define VEEPROM_PAGES_COUNT                 (2)
+
+#define VEEPROM_PAGE_STATE_INVALID          ((uint64_t)(0x0000000000000000))
+#define VEEPROM_PAGE_STATE_COPY             ((uint64_t)(0x000000000000FFFF))
+#define VEEPROM_PAGE_STATE_VALID            ((uint64_t)(0x00000000FFFFFFFF))
+#define VEEPROM_PAGE_STATE_WRITE            ((uint64_t)(0x0000FFFFFFFFFFFF))
+#define VEEPROM_PAGE_STATE_ERASED           ((uint64_t)(0xFFFFFFFFFFFFFFFF))
+
+// Service header in the end of page: [checksum unit][4 state units], unit size is program width
+#define VEEPROM_SERVICE_HEADER_SIZE(program_width)              (5 * (program_width))
+#define VEEPROM_SIZE(page_size, page_count, program_width)      ((page_size) * (page_count) - VEEPROM_SERVICE_HEADER_SIZE(program_width))
+
+
+// Instance configuration. Each VEEPROM page is page_count FLASH pages
+typedef struct {
+    uint32_t page_addr[VEEPROM_PAGES_COUNT];            // Pages addresses
+    uint32_t page_size;                                 // FLASH page (erase unit) size
+    uint32_t page_count;                                // FLASH pages count in VEEPROM page
+    uint32_t program_width;                             // FLASH program unit size: 2, 4 or 8 bytes (init fails if FLASH
+                                                        // port can't program it by one operation, see veeprom_flash.h)
+    uint8_t* cache;                                     // Write-back RAM image, VEEPROM_SIZE() bytes (NULL - write-through)
+    uint32_t flush_interval_us;                         // Max time between first write and flush for write-back mode. Non-zero
+                                                        // value requires VEEPROM_GET_TIME_US in project (init fails without it)
+} veeprom_config_t;
+
+// Instance context
+typedef struct {
+    veeprom_config_t config;                            // Instance configuration
+    uint32_t size;                                      // VEEPROM size in bytes
+    uint32_t active_page_addr;                          // Active page address (0 - instance is not initialized)
+    uint32_t inactive_page_addr;                        // Inactive page address
+    uint32_t page_erase_count[VEEPROM_PAGES_COUNT];     // Pages erase count (since power on)
+    uint32_t write_count;                               // Logical write operations count (since power on)
+    uint32_t page_swap_count;                           // Physical page swaps count (since power on)
+    uint32_t last_write_time_us;                        // Last page swap latency
+    bool is_cache_dirty;                                // RAM image has data which is not written to FLASH
+    uint32_t cache_dirty_time_us;                       // Time of first write after last flush
+    volatile bool is_busy;                              // FLASH operation (page swap or erase) is in progress
+    volatile bool is_flush_pending;                     // Flush is requested while instance is busy (power fail ISR)
+} veeprom_t;
+
+typedef struct {
+    uint32_t active_page_addr;                          // Active page address
+    uint32_t page_addr[VEEPROM_PAGES_COUNT];            // Pages addresses
+    uint64_t page_state[VEEPROM_PAGES_COUNT];           // Pages states
+    uint32_t page_erase_count[VEEPROM_PAGES_COUNT];     // Pages erase count (since power on)
+    uint32_t size;                                      // VEEPROM size in bytes
+    uint32_t program_width;                             // FLASH program unit size
+    uint16_t stored_checksum;                           // Active page checksum from page header
+    uint16_t calc_checksum;                             // Active page calculated checksum
+    uint32_t write_count;                               // Logical write operations count (since power on)
+    uint32_t page_swap_count;                           // Physical page swaps count (since power on)
+    uint32_t last_write_time_us;                        // Last page swap latency
+    bool is_dirty;                                      // RAM image has data which is not written to FLASH
+} veeprom_stat_t;
+
 
 //  ***************************************************************************
 /// @brief  VEEPROM driver initializetion
+/// @note   Write-back mode with non-zero flush interval requires time source
+///         (VEEPROM_GET_TIME_US), otherwise init fails
+/// @param  [out] veeprom: instance context
+/// @param  [in] config: instance configuration (copied into context)
 /// @return true - init success, false - fail
 //  ***************************************************************************
-extern bool veeprom_init();
+extern bool veeprom_init(veeprom_t* veeprom, const veeprom_config_t* config);
 
 //  ***************************************************************************
 /// @brief  Mass erase VEEPROM
+/// @param  [in] veeprom: instance context
 /// @return true - init success, false - fail
 //  ***************************************************************************
-extern bool veeprom_mass_erase();
+extern bool veeprom_mass_erase(veeprom_t* veeprom);
+
+//  ***************************************************************************
+/// @brief  Get VEEPROM size
+/// @param  [in] veeprom: instance context
+/// @return VEEPROM size in bytes
+//  ***************************************************************************
+extern uint32_t veeprom_get_size(const veeprom_t* veeprom);
+
+//  ***************************************************************************
+/// @brief  Get VEEPROM statistics
+/// @param  [in] veeprom: instance context
+/// @param  [out] stat: pointer to buffer for statistics
+//  ***************************************************************************
+extern void veeprom_get_stat(const veeprom_t* veeprom, veeprom_stat_t* stat);
 
 //  ***************************************************************************
 /// @brief  Read data from VEEPROM
+/// @param  [in] veeprom: instance context
 /// @param  [in] veeprom_addr: virtual address [0x0000...size-1]
 /// @param  [out] buffer: pointer to buffer for data
 /// @param  [in] bytes_count: bytes count for read
 /// @return true - init success, false - fail
 //  ***************************************************************************
-extern bool veeprom_read(uint32_t veeprom_addr, uint8_t* buffer, uint32_t bytes_count);
-extern uint8_t veeprom_read_8(uint32_t veeprom_addr);
-extern uint16_t veeprom_read_16(uint32_t veeprom_addr);
-extern uint32_t veeprom_read_32(uint32_t veeprom_addr);
+extern bool veeprom_read(const veeprom_t* veeprom, uint32_t veeprom_addr, uint8_t* buffer, uint32_t bytes_count);
+extern uint8_t veeprom_read_8(const veeprom_t* veeprom, uint32_t veeprom_addr);
+extern uint16_t veeprom_read_16(const veeprom_t* veeprom, uint32_t veeprom_addr);
+extern uint32_t veeprom_read_32(const veeprom_t* veeprom, uint32_t veeprom_addr);
 
 //  ***************************************************************************
 /// @brief  Write data to VEEPROM
+/// @note   In write-back mode data is written into RAM image only. RAM image
+///         is updated with IRQs masked, so power fail flush never sees
+///         partially copied data. Call it from main loop only
+/// @param  [in] veeprom: instance context
 /// @param  [in] veeprom_addr: virtual address [0x0000...size-1]
 /// @param  [out] data: pointer to data for write
 /// @param  [in] bytes_count: bytes count for write
 /// @return true - init success, false - fail
 //  ***************************************************************************
-extern bool veeprom_write(uint32_t veeprom_addr, uint8_t* data, uint32_t bytes_count);
-extern bool veeprom_write_8(uint32_t veeprom_addr, uint8_t  value);
-extern bool veeprom_write_16(uint32_t veeprom_addr, uint16_t value);
-extern bool veeprom_write_32(uint32_t veeprom_addr, uint32_t value);
+extern bool veeprom_write(veeprom_t* veeprom, uint32_t veeprom_addr, const uint8_t* data, uint32_t bytes_count);
+extern bool veeprom_write_8(veeprom_t* veeprom, uint32_t veeprom_addr, uint8_t  value);
+extern bool veeprom_write_16(veeprom_t* veeprom, uint32_t veeprom_addr, uint16_t value);
+extern bool veeprom_write_32(veeprom_t* veeprom, uint32_t veeprom_addr, uint32_t value);
+
+//  ***************************************************************************
+/// @brief  Write pending data from RAM image to FLASH
+/// @note   If other FLASH operation is in progress (call from ISR) flush is
+///         deferred and it is done by main loop when operation is completed
+/// @param  [in] veeprom: instance context
+/// @return true - success, false - fail or flush is deferred
+//  ***************************************************************************
+extern bool veeprom_flush(veeprom_t* veeprom);
+
+//  ***************************************************************************
+/// @brief  VEEPROM process (flush RAM image by interval). Call it from main loop
+/// @param  [in] veeprom: instance context
+//  ***************************************************************************
+extern void veeprom_process(veeprom_t* veeprom);
+
+//  ***************************************************************************
+/// @brief  Power fail warning handler. Call it from PVD/brownout interrupt
+/// @note   Interrupted page swap is never nested: flush is deferred until
+///         main loop completes running swap
+/// @param  [in] veeprom: instance context
+//  ***************************************************************************
+extern void veeprom_power_fail_handler(veeprom_t* veeprom);
 
 
 #endif // _VEEPROM_H_
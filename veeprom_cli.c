@@ -0,0 +1,323 @@
+//  ***************************************************************************
+/// @file    veeprom_cli.c
+/// @author  NeoProg
+//  ***************************************************************************
+#include "veeprom_cli.h"
+#include "veeprom.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define DUMP_LINE_BYTES_COUNT               (16)
+#define MAX_INSTANCES_COUNT                 (4)
+
+
+static cli_cmd_status_t cmd_get(cli_session_t* session, veeprom_t* veeprom, int32_t argc, char* argv[]);
+static cli_cmd_status_t cmd_set(cli_session_t* session, veeprom_t* veeprom, int32_t argc, char* argv[]);
+static cli_cmd_status_t cmd_dump(cli_session_t* session, veeprom_t* veeprom, int32_t argc, char* argv[]);
+static cli_cmd_status_t cmd_stat(cli_session_t* session, veeprom_t* veeprom);
+static cli_cmd_status_t cmd_flush(cli_session_t* session, veeprom_t* veeprom);
+
+static bool parse_number(const char* str, uint32_t* value);
+static void send_hex(cli_session_t* session, uint32_t value, int32_t digits);
+static void send_dec(cli_session_t* session, uint32_t value);
+static const char* page_state_to_string(uint64_t state);
+
+
+const char* const veeprom_cli_args[] = { "get", "set", "dump", "stat", "flush", NULL };
+
+static veeprom_t* instances[MAX_INSTANCES_COUNT] = {0};
+static uint32_t instances_count = 0;
+
+
+//  ***************************************************************************
+/// @brief  Attach VEEPROM instance to CLI (instance index is attach order)
+/// @param  veeprom: instance context
+/// @return true - success, false - too many instances
+//  ***************************************************************************
+bool veeprom_cli_attach(veeprom_t* veeprom) {
+    if (instances_count >= MAX_INSTANCES_COUNT) {
+        return false;
+    }
+    instances[instances_count++] = veeprom;
+    return true;
+}
+
+
+//  ***************************************************************************
+/// @brief  VEEPROM command handler
+/// @param  session: CLI session context
+/// @param  argc: arguments count
+/// @param  argv: arguments
+/// @return command status
+//  ***************************************************************************
+cli_cmd_status_t veeprom_cli_handler(cli_session_t* session, int32_t argc, char* argv[]) {
+    // Optional instance index: ee [index] <command> ...
+    uint32_t index = 0;
+    if (argc >= 2 && parse_number(argv[1], &index)) {
+        --argc;
+        ++argv;
+    }
+    if (index >= instances_count) {
+        cli_core_send(session, "Unknown VEEPROM instance\r\n");
+        return CLI_CMD_DONE;
+    }
+    veeprom_t* veeprom = instances[index];
+
+    if (argc >= 2) {
+        if (strcmp(argv[1], "get") == 0) {
+            return cmd_get(session, veeprom, argc, argv);
+        }
+        if (strcmp(argv[1], "set") == 0) {
+            return cmd_set(session, veeprom, argc, argv);
+        }
+        if (strcmp(argv[1], "dump") == 0) {
+            return cmd_dump(session, veeprom, argc, argv);
+        }
+        if (strcmp(argv[1], "stat") == 0) {
+            return cmd_stat(session, veeprom);
+        }
+        if (strcmp(argv[1], "flush") == 0) {
+            return cmd_flush(session, veeprom);
+        }
+    }
+    cli_core_send(session, "Usage: ee [index] get <addr> [count] | ee set <addr> <byte> [byte...] | ee dump [addr] [count] | ee stat | ee flush\r\n");
+    return CLI_CMD_DONE;
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Read bytes: ee get <addr> [count]
+/// @param  session: CLI session context
+/// @param  veeprom: VEEPROM instance
+/// @param  argc: arguments count
+/// @param  argv: arguments
+/// @return command status
+//  ***************************************************************************
+static cli_cmd_status_t cmd_get(cli_session_t* session, veeprom_t* veeprom, int32_t argc, char* argv[]) {
+    uint32_t addr = 0;
+    uint32_t count = 1;
+    if (argc < 3 || argc > 4 || !parse_number(argv[2], &addr) || (argc == 4 && !parse_number(argv[3], &count)) ||
+        count == 0 || count > DUMP_LINE_BYTES_COUNT) {
+        cli_core_send(session, "Usage: ee get <addr> [count: 1..16]\r\n");
+        return CLI_CMD_DONE;
+    }
+
+    uint8_t data[DUMP_LINE_BYTES_COUNT] = {0};
+    if (!veeprom_read(veeprom, addr, data, count)) {
+        cli_core_send(session, "Read error\r\n");
+        return CLI_CMD_DONE;
+    }
+
+    char line[DUMP_LINE_BYTES_COUNT * 3 + 3] = {0};
+    char* p = line;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (i != 0) {
+            *p++ = ' ';
+        }
+        p = cli_core_format_hex(p, data[i], 2);
+    }
+    strcpy(p, "\r\n");
+    cli_core_send(session, line);
+    return CLI_CMD_DONE;
+}
+
+//  ***************************************************************************
+/// @brief  Write bytes: ee set <addr> <byte> [byte...]
+/// @param  session: CLI session context
+/// @param  veeprom: VEEPROM instance
+/// @param  argc: arguments count
+/// @param  argv: arguments
+/// @return command status
+//  ***************************************************************************
+static cli_cmd_status_t cmd_set(cli_session_t* session, veeprom_t* veeprom, int32_t argc, char* argv[]) {
+    uint32_t addr = 0;
+    uint8_t data[CLI_MAX_ARGUMENTS_COUNT] = {0};
+    uint32_t count = 0;
+
+    bool is_valid = (argc >= 4) && parse_number(argv[2], &addr);
+    for (int32_t i = 3; i < argc && is_valid; ++i) {
+        uint32_t value = 0;
+        is_valid = parse_number(argv[i], &value) && value <= 0xFF;
+        data[count++] = (uint8_t)value;
+    }
+    if (!is_valid) {
+        cli_core_send(session, "Usage: ee set <addr> <byte> [byte...]\r\n");
+        return CLI_CMD_DONE;
+    }
+
+    cli_core_send(session, veeprom_write(veeprom, addr, data, count) ? "OK\r\n" : "Write error\r\n");
+    return CLI_CMD_DONE;
+}
+
+//  ***************************************************************************
+/// @brief  Stream hex dump: ee dump [addr] [count]
+/// @note   One line is sent per call, session->cmd_step contains dumped bytes count
+/// @param  session: CLI session context
+/// @param  veeprom: VEEPROM instance
+/// @param  argc: arguments count
+/// @param  argv: arguments
+/// @return command status
+//  ***************************************************************************
+static cli_cmd_status_t cmd_dump(cli_session_t* session, veeprom_t* veeprom, int32_t argc, char* argv[]) {
+    uint32_t addr = 0;
+    uint32_t count = veeprom_get_size(veeprom);
+    if (argc > 4 || (argc >= 3 && !parse_number(argv[2], &addr)) || (argc == 4 && !parse_number(argv[3], &count)) ||
+        addr >= veeprom_get_size(veeprom)) {
+        cli_core_send(session, "Usage: ee dump [addr] [count]\r\n");
+        return CLI_CMD_DONE;
+    }
+    if (count > veeprom_get_size(veeprom) - addr) {
+        count = veeprom_get_size(veeprom) - addr;
+    }
+
+    // Read next line
+    addr += session->cmd_step;
+    uint32_t line_count = count - session->cmd_step;
+    if (line_count > DUMP_LINE_BYTES_COUNT) {
+        line_count = DUMP_LINE_BYTES_COUNT;
+    }
+    uint8_t data[DUMP_LINE_BYTES_COUNT] = {0};
+    if (!veeprom_read(veeprom, addr, data, line_count)) {
+        cli_core_send(session, "Read error\r\n");
+        return CLI_CMD_DONE;
+    }
+
+    // Format line: AAAA: XX XX ... XX
+    char line[4 + 2 + DUMP_LINE_BYTES_COUNT * 3 + 3] = {0};
+    char* p = cli_core_format_hex(line, addr, 4);
+    *p++ = ':';
+    for (uint32_t i = 0; i < line_count; ++i) {
+        *p++ = ' ';
+        p = cli_core_format_hex(p, data[i], 2);
+    }
+    strcpy(p, "\r\n");
+    cli_core_send(session, line);
+
+    session->cmd_step += line_count;
+    return (session->cmd_step < count) ? CLI_CMD_CONTINUE : CLI_CMD_DONE;
+}
+
+//  ***************************************************************************
+/// @brief  Print VEEPROM statistics: ee stat
+/// @param  session: CLI session context
+/// @param  veeprom: VEEPROM instance
+/// @return command status
+//  ***************************************************************************
+static cli_cmd_status_t cmd_stat(cli_session_t* session, veeprom_t* veeprom) {
+    veeprom_stat_t stat;
+    veeprom_get_stat(veeprom, &stat);
+
+    cli_core_send(session, "active page: 0x");
+    send_hex(session, stat.active_page_addr, 8);
+    cli_core_send(session, ", size ");
+    send_dec(session, stat.size);
+    cli_core_send(session, ", program width ");
+    send_dec(session, stat.program_width);
+    cli_core_send(session, "\r\n");
+
+    for (uint32_t i = 0; i < VEEPROM_PAGES_COUNT; ++i) {
+        cli_core_send(session, "page 0x");
+        send_hex(session, stat.page_addr[i], 8);
+        cli_core_send(session, ": ");
+        cli_core_send(session, page_state_to_string(stat.page_state[i]));
+        cli_core_send(session, ", erases ");
+        send_dec(session, stat.page_erase_count[i]);
+        cli_core_send(session, "\r\n");
+    }
+
+    cli_core_send(session, "checksum: 0x");
+    send_hex(session, stat.stored_checksum, 4);
+    if (stat.stored_checksum == stat.calc_checksum) {
+        cli_core_send(session, " (OK)\r\n");
+    }
+    else {
+        cli_core_send(session, " (BAD, calculated 0x");
+        send_hex(session, stat.calc_checksum, 4);
+        cli_core_send(session, ")\r\n");
+    }
+
+    cli_core_send(session, "writes: ");
+    send_dec(session, stat.write_count);
+    cli_core_send(session, ", page swaps: ");
+    send_dec(session, stat.page_swap_count);
+    cli_core_send(session, ", writes per swap: ");
+    send_dec(session, stat.page_swap_count ? stat.write_count / stat.page_swap_count : 0);
+    cli_core_send(session, stat.is_dirty ? " (pending)" : "");
+    cli_core_send(session, "\r\nlast page swap: ");
+    send_dec(session, stat.last_write_time_us);
+    cli_core_send(session, " us\r\n");
+    return CLI_CMD_DONE;
+}
+
+//  ***************************************************************************
+/// @brief  Write pending data to FLASH: ee flush
+/// @param  session: CLI session context
+/// @param  veeprom: VEEPROM instance
+/// @return command status
+//  ***************************************************************************
+static cli_cmd_status_t cmd_flush(cli_session_t* session, veeprom_t* veeprom) {
+    cli_core_send(session, veeprom_flush(veeprom) ? "OK\r\n" : "Write error\r\n");
+    return CLI_CMD_DONE;
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Parse number (decimal, 0x - hex, 0 - octal)
+/// @param  str: string for parse
+/// @param  value: pointer to buffer for number
+/// @return true - success, false - string is not number
+//  ***************************************************************************
+static bool parse_number(const char* str, uint32_t* value) {
+    char* end = NULL;
+    *value = strtoul(str, &end, 0);
+    return end != str && *end == 0;
+}
+
+//  ***************************************************************************
+/// @brief  Send number in HEX format
+/// @param  session: CLI session context
+/// @param  value: number
+/// @param  digits: digits count
+/// @return none
+//  ***************************************************************************
+static void send_hex(cli_session_t* session, uint32_t value, int32_t digits) {
+    char str[9] = {0};
+    cli_core_format_hex(str, value, digits);
+    cli_core_send(session, str);
+}
+
+//  ***************************************************************************
+/// @brief  Send number in decimal format
+/// @param  session: CLI session context
+/// @param  value: number
+/// @return none
+//  ***************************************************************************
+static void send_dec(cli_session_t* session, uint32_t value) {
+    char str[11] = {0};
+    cli_core_format_dec(str, value);
+    cli_core_send(session, str);
+}
+
+//  ***************************************************************************
+/// @brief  Get page state name
+/// @param  state: page state
+/// @return page state name
+//  ***************************************************************************
+static const char* page_state_to_string(uint64_t state) {
+    switch (state) {
+        case VEEPROM_PAGE_STATE_INVALID: return "INVALID";
+        case VEEPROM_PAGE_STATE_COPY:    return "COPY";
+        case VEEPROM_PAGE_STATE_VALID:   return "VALID";
+        case VEEPROM_PAGE_STATE_WRITE:   return "WRITE";
+        case VEEPROM_PAGE_STATE_ERASED:  return "ERASED";
+        default:                         return "UNKNOWN";
+    }
+}
@@ -0,0 +1,40 @@
+//  ***************************************************************************
+/// @file    veeprom_cli.h
+/// @author  NeoProg
+/// @brief   VEEPROM CLI commands
+//  ***************************************************************************
+#ifndef _VEEPROM_CLI_H_
+#define _VEEPROM_CLI_H_
+#include "cli_core.h"
+#include "veeprom.h"
+
+// Command description for command registry
+#define VEEPROM_CLI_CMD                     { .name = "ee", .args = veeprom_cli_args, .handler = veeprom_cli_handler }
+
+
+extern const char* const veeprom_cli_args[];
+
+//  ***************************************************************************
+/// @brief  Attach VEEPROM instance to CLI (instance index is attach order)
+/// @param  veeprom: instance context
+/// @return true - success, false - too many instances
+//  ***************************************************************************
+extern bool veeprom_cli_attach(veeprom_t* veeprom);
+
+//  ***************************************************************************
+/// @brief  VEEPROM command handler
+/// @note   Optional instance index can be set before command: ee 1 stat (default 0)
+///         ee get <addr> [count]        - read up to 16 bytes
+///         ee set <addr> <byte> [byte]  - write bytes
+///         ee dump [addr] [count]       - stream hex dump (one line per call)
+///         ee stat                      - print pages state and statistics
+///         ee flush                     - write pending data (write-back mode)
+/// @param  session: CLI session context
+/// @param  argc: arguments count
+/// @param  argv: arguments
+/// @return command status
+//  ***************************************************************************
+extern cli_cmd_status_t veeprom_cli_handler(cli_session_t* session, int32_t argc, char* argv[]);
+
+
+#endif // _VEEPROM_CLI_H_
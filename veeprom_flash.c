@@ -0,0 +1,108 @@
+//  ***************************************************************************
+/// @file    veeprom_flash.c
+/// @author  NeoProg
+/// @brief   VEEPROM FLASH port for STM32 (FLASH with 16-bit programming, use program width 2)
+//  ***************************************************************************
+#include "veeprom_flash.h"
+#include "project_base.h"
+
+
+static bool flash_wait_and_check();
+
+
+//  ***************************************************************************
+/// @brief  Lock/unlock FLASH
+/// @return true - init success, false - fail
+//  ***************************************************************************
+bool veeprom_flash_lock() {
+    FLASH->CR |= FLASH_CR_LOCK;
+    return (FLASH->CR & FLASH_CR_LOCK) == FLASH_CR_LOCK;
+}
+bool veeprom_flash_unlock() {
+    if (FLASH->CR & FLASH_CR_LOCK) {
+        FLASH->KEYR = 0x45670123;
+        FLASH->KEYR = 0xCDEF89AB;
+    }
+    return (FLASH->CR & FLASH_CR_LOCK) != FLASH_CR_LOCK;
+}
+
+//  ***************************************************************************
+/// @brief  Erase FLASH page
+/// @param  [in] flash_addr: page address for erase
+/// @return true - success, false - fail
+//  ***************************************************************************
+bool veeprom_flash_page_erase(uint32_t flash_addr) {
+    veeprom_flash_unlock();
+    
+    FLASH->CR |= FLASH_CR_PER;
+    FLASH->AR = flash_addr;
+    FLASH->CR |= FLASH_CR_STRT;
+    bool result = flash_wait_and_check();
+    FLASH->CR &= ~FLASH_CR_PER;
+    
+    veeprom_flash_lock();
+    return result;
+}
+
+//  ***************************************************************************
+/// @brief  Read data from FLASH in BE format
+/// @param  [in] flash_addr: cell address
+/// @return cell value
+//  ***************************************************************************
+uint8_t veeprom_flash_read_8(uint32_t flash_addr) {
+    return *((uint8_t*)flash_addr);
+}
+uint16_t veeprom_flash_read_16(uint32_t flash_addr) {
+    return __REV16(*((uint16_t*)flash_addr));
+}
+uint32_t veeprom_flash_read_32(uint32_t flash_addr) {
+    return __REV(*((uint32_t*)flash_addr));
+}
+
+//  ***************************************************************************
+/// @brief  Check FLASH program unit size
+/// @note   FLASH programs half-words only. Wider unit would be several program
+///         operations and it is not power loss safe
+/// @param  [in] width: unit size
+/// @return true - unit is programmed natively, false - not supported
+//  ***************************************************************************
+bool veeprom_flash_is_width_supported(uint32_t width) {
+    return width == 2;
+}
+
+//  ***************************************************************************
+/// @brief  Program one FLASH unit (half-word)
+/// @param  [in] flash_addr: unit address (aligned to width)
+/// @param  [in] data: unit data
+/// @param  [in] width: unit size - 2 bytes
+/// @return true - success, false - fail
+//  ***************************************************************************
+bool veeprom_flash_program(uint32_t flash_addr, const uint8_t* data, uint32_t width) {
+    if (width != 2) {
+        return false;
+    }
+    FLASH->CR |= FLASH_CR_PG;
+    *((volatile uint16_t*)flash_addr) = (uint16_t)(data[0] | (data[1] << 8));
+    bool result = flash_wait_and_check();
+    FLASH->CR &= ~FLASH_CR_PG;
+    
+    return result && veeprom_flash_read_8(flash_addr) == data[0] && veeprom_flash_read_8(flash_addr + 1) == data[1];
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Wait FLASH operation complete
+/// @return true - operation comleted, false - operation comleted with error
+//  ***************************************************************************
+static bool flash_wait_and_check() {
+    while (FLASH->SR & FLASH_SR_BSY);
+    if (FLASH->SR & (FLASH_SR_PGERR | FLASH_SR_WRPRTERR)) {
+        FLASH->SR |= FLASH_SR_PGERR | FLASH_SR_WRPRTERR | FLASH_SR_EOP;
+        return false;
+    }
+    FLASH->SR |= FLASH_SR_PGERR | FLASH_SR_WRPRTERR | FLASH_SR_EOP;
+    return true;
+}
@@ -0,0 +1,56 @@
+//  ***************************************************************************
+/// @file    veeprom_flash.h
+/// @author  NeoProg
+/// @brief   VEEPROM FLASH port. Implement this functions for use VEEPROM
+///          driver on other MCU or with simulated FLASH on host
+//  ***************************************************************************
+#ifndef _VEEPROM_FLASH_H_
+#define _VEEPROM_FLASH_H_
+#include <stdint.h>
+#include <stdbool.h>
+
+
+//  ***************************************************************************
+/// @brief  Lock/unlock FLASH
+/// @return true - success, false - fail
+//  ***************************************************************************
+extern bool veeprom_flash_lock();
+extern bool veeprom_flash_unlock();
+
+//  ***************************************************************************
+/// @brief  Erase FLASH page
+/// @param  [in] flash_addr: page address for erase
+/// @return true - success, false - fail
+//  ***************************************************************************
+extern bool veeprom_flash_page_erase(uint32_t flash_addr);
+
+//  ***************************************************************************
+/// @brief  Read data from FLASH in BE format
+/// @param  [in] flash_addr: cell address
+/// @return cell value
+//  ***************************************************************************
+extern uint8_t  veeprom_flash_read_8(uint32_t flash_addr);
+extern uint16_t veeprom_flash_read_16(uint32_t flash_addr);
+extern uint32_t veeprom_flash_read_32(uint32_t flash_addr);
+
+//  ***************************************************************************
+/// @brief  Check FLASH program unit size
+/// @note   Unit should be programmed by one FLASH operation: parts with ECC
+///         reject second program of ECC word, so unit can't be split
+/// @param  [in] width: unit size - 2, 4 or 8 bytes
+/// @return true - unit is programmed natively, false - not supported
+//  ***************************************************************************
+extern bool veeprom_flash_is_width_supported(uint32_t width);
+
+//  ***************************************************************************
+/// @brief  Program one FLASH unit (FLASH should be unlocked)
+/// @note   Unit is programmed once after erase. Bytes are placed in memory order
+/// @param  [in] flash_addr: unit address (aligned to width)
+/// @param  [in] data: unit data
+/// @param  [in] width: unit size (veeprom_flash_is_width_supported() is true)
+/// @return true - success, false - fail
+//  ***************************************************************************
+extern bool veeprom_flash_program(uint32_t flash_addr, const uint8_t* data, uint32_t width);
+
+
+#endif // _VEEPROM_FLASH_H_